@@ -0,0 +1,117 @@
+/**
+ *  Jsonpack - Multi-threaded decoding throughput
+ *
+ *  Every thread decodes the same document with its own jsonpack::parser,
+ *  the documents per second are reported for 1, 2, 4 ... threads up to the
+ *  given maximum.
+ *
+ *  Usage: threads_benchmark [max_threads] [docs_per_thread]
+ */
+
+#include <jsonpack.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+struct Point
+{
+    Point(): x(0), y(0) {}
+
+    double x;
+    double y;
+
+    DEFINE_JSON_ATTRIBUTES(x, y)
+};
+
+struct Record
+{
+    Record(): id(0), score(0.0), active(false), name(), tags(), origin(), path() {}
+
+    long id;
+    double score;
+    bool active;
+    std::string name;
+    std::vector<std::string> tags;
+    Point origin;
+    std::vector<Point> path;
+
+    DEFINE_JSON_ATTRIBUTES(id, score, active, name, tags, origin, path)
+};
+
+static void decode(const char* json, std::size_t len, std::size_t docs)
+{
+    jsonpack::parser p;     // one parser per thread, no shared state
+    Record r;
+
+    for(std::size_t i = 0; i < docs; ++i)
+    {
+        r.tags.clear();
+        r.path.clear();
+        r.json_unpack(json, len, p);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned max_threads = argc > 1 ? static_cast<unsigned>(atoi(argv[1])) : std::thread::hardware_concurrency();
+    std::size_t docs = argc > 2 ? static_cast<std::size_t>(atol(argv[2])) : 200000;
+
+    if(max_threads == 0)
+        max_threads = 1;
+
+    Record src;
+    src.id = 1234567890L;
+    src.score = 98.625;
+    src.active = true;
+    src.name = "sensor north gateway";
+    src.tags.push_back("alpha");
+    src.tags.push_back("beta");
+    src.tags.push_back("gamma");
+    src.origin.x = 1.5;
+    src.origin.y = -2.25;
+    for(int i = 0; i < 8; ++i)
+    {
+        Point pt;
+        pt.x = i * 0.5;
+        pt.y = i * -0.25;
+        src.path.push_back(pt);
+    }
+
+    char* json = src.json_pack();
+    std::size_t len = strlen(json);
+
+    printf("document: %zu bytes, %zu documents per thread\n", len, docs);
+    printf("%8s %16s %10s\n", "threads", "documents/s", "speedup");
+
+    double single = 0;
+    for(unsigned n = 1; ; n *= 2)
+    {
+        if(n > max_threads)
+            n = max_threads;
+
+        std::vector<std::thread> pool;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(unsigned t = 0; t < n; ++t)
+            pool.push_back( std::thread(decode, json, len, docs) );
+        for(unsigned t = 0; t < n; ++t)
+            pool[t].join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double rate = (static_cast<double>(docs) * n) / seconds;
+        if(n == 1)
+            single = rate;
+
+        printf("%8u %16.0f %9.2fx\n", n, rate, rate / single);
+
+        if(n == max_threads)
+            break;
+    }
+
+    free(json);
+    return 0;
+}
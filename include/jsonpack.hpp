@@ -22,6 +22,8 @@
 #include "jsonpack/parser.hpp"
 #include "jsonpack/exceptions.hpp"
 #include "jsonpack/config.hpp"
+#include "jsonpack/buffer_pool.hpp"
+#include "jsonpack/sink.hpp"
 
 #ifdef JSONPACK_USE_VARIADIC_TEMPLATES
 #include "jsonpack/serializer/serializer_cpp11.hpp"
@@ -41,56 +43,160 @@
 #endif
 
 
-#ifndef _MSC_VER
+/**
+ * DEFINE_JSON_ATTRIBUTES adds member functions and a nested type only, bound
+ * types keep the size and layout of the plain struct. The attribute names are
+ * static per type and the parsing workspace comes from the jsonpack::parser
+ * used on each call.
+ *
+ * json_append writes the object at the end of any sink (see jsonpack/sink.hpp):
+ * a jsonpack::buffer, a fixed span, a file or an iovec list. Nested bound
+ * objects are serialized through it into the sink of the parent. The sinks
+ * but jsonpack::buffer are taken through a jsonpack::sink_ref, so no member
+ * is a template and the macro can be used in function local classes.
+ *
+ * json_pack serializes into a buffer of the thread pool (jsonpack/buffer_pool.hpp)
+ * and returns a malloc copy of the exact size, to be freed by the caller.
+ *
+ * json_pack_into(buffer) replaces the content of a buffer kept by the caller,
+ * its memory is reused from one call to the next. json_pack_into(out, capacity)
+ * writes a NUL terminated json into out as snprintf does and returns the
+ * length of the whole json, the output is truncated if it is not less than
+ * capacity.
+ *
+ * json_size returns the exact length of the json without writing it, so a
+ * network frame or shared memory slot can be sized before packing. Integers
+ * and strings are measured without formatting them, reals are formatted.
+ *
+ * json_unpack decodes the members in a single pass over the json text, the
+ * values of the keys that are not attributes are skipped without parsing.
+ * json_unpack_insitu decodes the string escapes in place, modifying json.
+ */
+#ifdef JSONPACK_USE_VARIADIC_TEMPLATES
 #define DEFINE_JSON_ATTRIBUTES(...)                                     \
+    private:                                                            \
+    struct _json_names                                                  \
+    {                                                                   \
+        static constexpr const char* str() { return #__VA_ARGS__; }     \
+    };                                                                  \
     public:                                                             \
     char* json_pack()                                                   \
     {                                                                   \
-        jsonpack::buffer json;                                          \
+        jsonpack::pooled_buffer json;                                   \
+        json_append(json.get());                                        \
+        return json.get().copy();                                       \
+    }                                                                   \
+    void json_pack_into(jsonpack::buffer &json) const                   \
+    {                                                                   \
+        json.clear();                                                   \
+        json_append(json);                                              \
+    }                                                                   \
+    std::size_t json_pack_into(char* out, std::size_t capacity) const   \
+    {                                                                   \
+        jsonpack::span_sink json(out, capacity);                        \
+        json_append(json);                                              \
+        return json.terminate();                                        \
+    }                                                                   \
+    void json_append(jsonpack::buffer &json) const                      \
+    {                                                                   \
         json.append( "{" , 1);                                          \
-        jsonpack::make_json(json, _keys ,__VA_ARGS__);                  \
-        return json.release();                                          \
+        jsonpack::make_json<_json_names>(json, __VA_ARGS__);            \
+    }                                                                   \
+    void json_append(const jsonpack::sink_ref &sink) const              \
+    {                                                                   \
+        jsonpack::sink_ref json(sink);                                  \
+        json.append( "{" , 1);                                          \
+        jsonpack::make_json<_json_names>(json, __VA_ARGS__);            \
+    }                                                                   \
+    std::size_t json_size() const                                       \
+    {                                                                   \
+        return jsonpack::json_size<_json_names>(__VA_ARGS__);           \
     }                                                                   \
     void json_unpack(const char* json, const std::size_t &len)          \
     {                                                                   \
-         if(jsonpack::parser::json_validate(json, len, _members))       \
-         {                                                              \
-            jsonpack::make_object(_members, const_cast<char*>(json), _keys, __VA_ARGS__);\
-            jsonpack::clean_object(_members);                           \
-        }else{throw jsonpack::invalid_json(jsonpack::parser::error_.c_str());}                          \
+        jsonpack::parser p;                                             \
+        json_unpack(json, len, p);                                      \
     }                                                                   \
-    void json_unpack(const jsonpack::object_t &json, char* json_ptr)    \
+    void json_unpack_insitu(char* json, const std::size_t &len)         \
     {                                                                   \
-            jsonpack::make_object(json, json_ptr, _keys, __VA_ARGS__);  \
+        jsonpack::parser p(jsonpack::PARSE_INSITU);                     \
+        json_unpack(json, len, p);                                      \
     }                                                                   \
-    private:                                                            \
-    std::string _keys = jsonpack::util::trim( std::string(#__VA_ARGS__) );\
-    jsonpack::object_t _members = jsonpack::object_t(32);
+    void json_unpack(const char* json, const std::size_t &len, jsonpack::parser &p) \
+    {                                                                   \
+        p.reset();                                                      \
+        auto _decoder = jsonpack::make_decoder<_json_names>(const_cast<char*>(json), __VA_ARGS__);\
+        if( !p.json_decode(json, len, _decoder) )                       \
+        {                                                               \
+            throw jsonpack::invalid_json(p.error_.c_str());             \
+        }                                                               \
+    }                                                                   \
+    void json_unpack(const jsonpack::object_t &json, char* json_ptr)    \
+    {                                                                   \
+            jsonpack::make_object<_json_names>(json, json_ptr, __VA_ARGS__);\
+    }
 #else
 #define DEFINE_JSON_ATTRIBUTES(...)                                     \
     public:                                                             \
+    static const std::string& _json_keys()                              \
+    {                                                                   \
+        static const std::string keys = jsonpack::util::trim( std::string(#__VA_ARGS__) );\
+        return keys;                                                    \
+    }                                                                   \
     char* json_pack()                                                   \
     {                                                                   \
-        std::string _keys = jsonpack::util::trim( std::string(#__VA_ARGS__) );\
-        jsonpack::buffer json;                                          \
+        jsonpack::pooled_buffer json;                                   \
+        json_append(json.get());                                        \
+        return json.get().copy();                                       \
+    }                                                                   \
+    void json_pack_into(jsonpack::buffer &json) const                   \
+    {                                                                   \
+        json.clear();                                                   \
+        json_append(json);                                              \
+    }                                                                   \
+    std::size_t json_pack_into(char* out, std::size_t capacity) const   \
+    {                                                                   \
+        jsonpack::span_sink json(out, capacity);                        \
+        json_append(json);                                              \
+        return json.terminate();                                        \
+    }                                                                   \
+    void json_append(jsonpack::buffer &json) const                      \
+    {                                                                   \
+        json.append( "{" , 1);                                          \
+        jsonpack::make_json(json, _json_keys() ,__VA_ARGS__);           \
+    }                                                                   \
+    void json_append(const jsonpack::sink_ref &sink) const              \
+    {                                                                   \
+        jsonpack::sink_ref json(sink);                                  \
         json.append( "{" , 1);                                          \
-        jsonpack::make_json(json, _keys ,__VA_ARGS__);                  \
-        return json.release();                                          \
+        jsonpack::make_json(json, _json_keys() ,__VA_ARGS__);           \
+    }                                                                   \
+    std::size_t json_size() const                                       \
+    {                                                                   \
+        return (jsonpack::size_counter(), __VA_ARGS__).object_size(_json_keys());\
     }                                                                   \
     void json_unpack(const char* json, const std::size_t &len)          \
     {                                                                   \
-        jsonpack::object_t _members = jsonpack::object_t(32);           \
-         if(jsonpack::parser::json_validate(json, len, _members))       \
+        jsonpack::parser p;                                             \
+        json_unpack(json, len, p);                                      \
+    }                                                                   \
+    void json_unpack_insitu(char* json, const std::size_t &len)         \
+    {                                                                   \
+        jsonpack::parser p(jsonpack::PARSE_INSITU);                     \
+        json_unpack(json, len, p);                                      \
+    }                                                                   \
+    void json_unpack(const char* json, const std::size_t &len, jsonpack::parser &p) \
+    {                                                                   \
+        p.reset();                                                      \
+        jsonpack::object_t &_members = *jsonpack::new_object(p.get_arena());\
+         if(p.json_validate(json, len, _members))                       \
          {                                                              \
-            std::string _keys = jsonpack::util::trim( std::string(#__VA_ARGS__) );\
-            jsonpack::make_object(_members, const_cast<char*>(json), _keys, __VA_ARGS__);\
-            jsonpack::clean_object(_members);                           \
-        }else{throw jsonpack::invalid_json(jsonpack::parser::error_.c_str());}  \
+            jsonpack::make_object(_members, const_cast<char*>(json), _json_keys(), __VA_ARGS__);\
+        }else{throw jsonpack::invalid_json(p.error_.c_str());}          \
     }                                                                   \
     void json_unpack(const jsonpack::object_t &json, char* json_ptr)    \
     {                                                                   \
-        std::string _keys = jsonpack::util::trim( std::string(#__VA_ARGS__) );\
-        jsonpack::make_object(json, json_ptr, _keys, __VA_ARGS__);      \
+        jsonpack::make_object(json, json_ptr, _json_keys(), __VA_ARGS__);\
     }
 #endif
 
@@ -109,25 +215,69 @@ JSONPACK_API_BEGIN_NAMESPACE
 template<typename Seq>
 inline char* json_pack_sequence(const Seq& seq)
 {
-    jsonpack::buffer json;
+    jsonpack::pooled_buffer json;
+    type::json_traits< Seq >::append(json.get(), seq);
+    json.get().erase_last_comma();
+
+    return json.get().copy();
+}
+
+/**
+ * Tempate function to serialize arrays from standard sequences at the end
+ * of any sink, see jsonpack/sink.hpp
+ */
+template<typename Seq, typename Sink>
+inline void json_append_sequence(const Seq& seq, Sink &json)
+{
     type::json_traits< Seq >::append(json, seq);
     json.erase_last_comma();
-    json.append("\0",  1);
+}
+
+/**
+ * Serialize a bound object at the end of any sink, see jsonpack/sink.hpp
+ */
+template<typename T, typename Sink>
+inline void json_append(const T& value, Sink &json)
+{
+    value.json_append(json);
+}
+
+/**
+ * Exact size of the json written by json_pack_sequence, nothing is written
+ */
+template<typename Seq>
+inline std::size_t json_sequence_size(const Seq& seq)
+{
+    return type::json_traits< Seq >::size(seq) - 1;     // without the last comma
+}
 
-    return json.release();
+/**
+ * Tempate function to serialize arrays from standard sequences into a buffer
+ * kept by the caller, its previous content is replaced. The json is not NUL
+ * terminated, its length is json.size().
+ */
+template<typename Seq>
+inline void json_pack_sequence(const Seq& seq, buffer &json)
+{
+    json.clear();
+    type::json_traits< Seq >::append(json, seq);
+    json.erase_last_comma();
 }
 
 /**
  * Tempate function to deserialize arrays into standard sequences
  * Allowed sequences:
  * array, vector, deque, list, forward_list, set, multiset, unordered_set, unordered_multiset
+ * The given parser is used for the whole operation, so concurrent calls must use
+ * different parser instances.
  */
 template<typename Seq>
-inline void json_unpack_sequence(const char* json, const std::size_t &len, Seq& seq)
+inline void json_unpack_sequence(const char* json, const std::size_t &len, Seq& seq, parser &p)
 {
-    array_t *arr = new array_t();
+    p.reset();
+    array_t *arr = new_array(p.get_arena());
 
-    if(parser::json_validate(json, len, *arr))
+    if(p.json_validate(json, len, *arr))
     {
         value v;
         v._arr = arr;
@@ -137,10 +287,20 @@ inline void json_unpack_sequence(const char* json, const std::size_t &len, Seq&
     }
     else
     {
-        throw jsonpack::invalid_json(jsonpack::parser::error_.c_str());
+        throw jsonpack::invalid_json(p.error_.c_str());
     }
+}
 
-    delete_array(arr);
+/**
+ * Tempate function to deserialize arrays into standard sequences
+ * Allowed sequences:
+ * array, vector, deque, list, forward_list, set, multiset, unordered_set, unordered_multiset
+ */
+template<typename Seq>
+inline void json_unpack_sequence(const char* json, const std::size_t &len, Seq& seq)
+{
+    parser p;
+    json_unpack_sequence(json, len, seq, p);
 }
 
 
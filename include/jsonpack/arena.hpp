@@ -0,0 +1,223 @@
+/**
+ *  Jsonpack - Bump allocator for parsed values
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_ARENA_HPP
+#define JSONPACK_ARENA_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "jsonpack/exceptions.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/**
+ * Memory arena: allocations bump a pointer inside a chunk and are released
+ * all together by reset(). After a reset the memory is kept for reuse, so a
+ * long-lived arena reaches a steady state where no allocation hits malloc.
+ */
+class arena
+{
+public:
+    arena(std::size_t chunk_size = 4096)
+        : _head(nullptr),
+          _top(nullptr),
+          _end(nullptr),
+          _chunk_size(chunk_size)
+    {}
+
+    ~arena()
+    {
+        release();
+    }
+
+public:
+    /**
+     * Get bytes aligned memory from the current chunk, a new chunk is
+     * allocated when the current one is exhausted
+     */
+    void* allocate(std::size_t bytes, std::size_t align = sizeof(void*))
+    {
+        char* p = align_up(_top, align);
+
+        // alignment can move p past the end of an almost full chunk
+        if(_top == nullptr || p > _end || static_cast<std::size_t>(_end - p) < bytes)
+        {
+            new_chunk(bytes + align);
+            p = align_up(_top, align);
+        }
+
+        _top = p + bytes;
+        return p;
+    }
+
+    /**
+     * Only the last allocation can be given back, any other is reclaimed by reset()
+     */
+    void deallocate(void* p, std::size_t bytes)
+    {
+        if(static_cast<char*>(p) + bytes == _top)
+            _top = static_cast<char*>(p);
+    }
+
+    /**
+     * Release all the allocations at once. If several chunks were needed they
+     * are merged in a single one, so the next use fits without growing
+     */
+    void reset()
+    {
+        if(_head == nullptr)
+            return;
+
+        if(_head->_next != nullptr)
+        {
+            std::size_t total = 0;
+            for(chunk* c = _head; c != nullptr; c = c->_next)
+                total += c->_size;
+
+            release();
+            new_chunk(total);
+        }
+        else
+        {
+            _top = reinterpret_cast<char*>(_head + 1);
+        }
+    }
+
+private:
+    struct chunk
+    {
+        chunk* _next;
+        std::size_t _size;
+    };
+
+    static char* align_up(char* p, std::size_t align)
+    {
+        std::size_t mod = reinterpret_cast<std::size_t>(p) % align;
+        return mod ? p + (align - mod) : p;
+    }
+
+    void new_chunk(std::size_t min_size)
+    {
+        std::size_t size = (_head != nullptr) ? _head->_size * 2 : _chunk_size;
+        if(size < min_size)
+            size = min_size;
+
+        chunk* c = static_cast<chunk*>( malloc(sizeof(chunk) + size) );
+        if(!c)
+        {
+            throw alloc_error();
+        }
+
+        c->_next = _head;
+        c->_size = size;
+        _head = c;
+        _top = reinterpret_cast<char*>(c + 1);
+        _end = _top + size;
+    }
+
+    void release()
+    {
+        while(_head != nullptr)
+        {
+            chunk* next = _head->_next;
+            free(_head);
+            _head = next;
+        }
+        _top = _end = nullptr;
+    }
+
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    arena(const arena&) = delete ;
+    arena& operator=(const arena&) = delete ;
+#else
+    arena(const arena&) ;
+    arena& operator=(const arena&) ;
+#endif
+
+private:
+    chunk* _head;
+    char* _top;
+    char* _end;
+    std::size_t _chunk_size;
+};
+
+/**
+ * Standard allocator over an arena. A default constructed allocator has no
+ * arena and uses the global heap, so containers can still be used standalone
+ */
+template<typename T>
+struct arena_allocator
+{
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef arena_allocator<U> other;
+    };
+
+    arena_allocator() : _arena(nullptr) {}
+
+    explicit arena_allocator(arena* a) : _arena(a) {}
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U> &other) : _arena(other._arena) {}
+
+    T* allocate(std::size_t n)
+    {
+        if(_arena != nullptr)
+            return static_cast<T*>( _arena->allocate(n * sizeof(T), alignof(T)) );
+
+        return static_cast<T*>( ::operator new(n * sizeof(T)) );
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        if(_arena != nullptr)
+            _arena->deallocate(p, n * sizeof(T));
+        else
+            ::operator delete(p);
+    }
+
+    arena* _arena;
+};
+
+template<typename T, typename U>
+inline bool operator==(const arena_allocator<T> &a, const arena_allocator<U> &b)
+{
+    return a._arena == b._arena;
+}
+
+template<typename T, typename U>
+inline bool operator!=(const arena_allocator<T> &a, const arena_allocator<U> &b)
+{
+    return a._arena != b._arena;
+}
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_ARENA_HPP
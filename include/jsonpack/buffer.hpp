@@ -19,6 +19,8 @@
 #ifndef JSONPACK_BUFFER_HPP
 #define JSONPACK_BUFFER_HPP
 
+#include <stdlib.h>
+#include <string.h>
 #include <string>
 
 #include "exceptions.hpp"
@@ -87,6 +89,43 @@ public:
         return _size;
     }
 
+    size_t capacity() const
+    {
+        return _alloc;
+    }
+
+    /**
+     * Copy the content to out as snprintf does: at most capacity - 1 bytes
+     * and a terminating NUL. Return the content size, the copy is complete
+     * only if it is less than capacity.
+     */
+    size_t copy_to(char* out, size_t capacity) const
+    {
+        if(capacity > 0)
+        {
+            size_t n = (_size < capacity) ? _size : capacity - 1;
+            memcpy(out, _data, n);
+            out[n] = '\0';
+        }
+        return _size;
+    }
+
+    /**
+     * A NUL terminated copy of the content in a malloc block of its exact
+     * size, freed by the caller
+     */
+    char* copy() const
+    {
+        char* out = (char*) malloc(_size + 1);
+
+        if(!out)
+        {
+            throw alloc_error();
+        }
+        copy_to(out, _size + 1);
+        return out;
+    }
+
     char* release()
     {
         char* tmp = _data;
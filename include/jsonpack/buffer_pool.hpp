@@ -0,0 +1,101 @@
+/**
+ *  Jsonpack - Per thread pool of serialization buffers
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_BUFFER_POOL_HPP
+#define JSONPACK_BUFFER_POOL_HPP
+
+#include "jsonpack/buffer.hpp"
+#include "jsonpack/config.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/**
+ * Free list of serialization buffers kept per thread, so repeated packing
+ * reuses the memory of the previous calls instead of a new malloc each time.
+ * The buffers are released at thread exit. Without thread_local support
+ * (JSONPACK_HAS_THREAD_LOCAL) every acquire allocates a new buffer.
+ */
+struct buffer_pool
+{
+    /**
+     * Buffers kept by each thread, the others are freed when released
+     */
+    static const std::size_t max_pooled = 4;
+
+    /**
+     * Buffers grown over this capacity are freed instead of kept
+     */
+    static const std::size_t max_capacity = 1 << 20;
+
+    /**
+     * An empty buffer of the calling thread
+     */
+    static buffer* acquire();
+
+    /**
+     * Give back a buffer taken by acquire() in the same thread
+     */
+    static void release(buffer* b);
+};
+
+/**
+ * Buffer taken from the pool of the calling thread for the scope
+ *
+ * Usage:
+ *   jsonpack::pooled_buffer json;
+ *   obj.json_append(json.get());
+ *   write(fd, json.get().data(), json.get().size());
+ */
+class pooled_buffer
+{
+public:
+    pooled_buffer():
+        _buffer( buffer_pool::acquire() )
+    {}
+
+    ~pooled_buffer()
+    {
+        buffer_pool::release(_buffer);
+    }
+
+    buffer& get()
+    {
+        return *_buffer;
+    }
+
+    const buffer& get() const
+    {
+        return *_buffer;
+    }
+
+private:
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    pooled_buffer(const pooled_buffer&) = delete ;
+    pooled_buffer& operator=(const pooled_buffer&) = delete ;
+#else
+    pooled_buffer(const pooled_buffer&) ;
+    pooled_buffer& operator=(const pooled_buffer&) ;
+#endif
+
+    buffer* _buffer;
+};
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_BUFFER_POOL_HPP
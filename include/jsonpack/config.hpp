@@ -23,6 +23,14 @@
 #   if (__cplusplus >= 201103) & !defined(_MSC_VER)
 #       define JSONPACK_USE_VARIADIC_TEMPLATES
 #   endif
+#   if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#       define JSONPACK_HAS_STRING_VIEW
+#   endif
+#   if ( (__cplusplus >= 201103) && (defined(__clang__) || !defined(__GNUC__) || \
+          (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))) ) || \
+       (defined(_MSC_VER) && _MSC_VER >= 1900)
+#       define JSONPACK_HAS_THREAD_LOCAL
+#   endif
 #endif
 
 /**
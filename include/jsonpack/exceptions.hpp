@@ -66,6 +66,26 @@ public:
     alloc_error(const char* what): jsonpack_error(what){}
 };
 
+/**
+ *
+ */
+class io_error : public jsonpack_error
+{
+public:
+    io_error(){}
+    io_error(const char* what): jsonpack_error(what){}
+};
+
+/**
+ *
+ */
+class invalid_pointer : public jsonpack_error
+{
+public:
+    invalid_pointer(){}
+    invalid_pointer(const char* what): jsonpack_error(what){}
+};
+
 
 JSONPACK_API_END_NAMESPACE
 
@@ -0,0 +1,264 @@
+/**
+ *  Jsonpack - On demand access to a JSON document
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_LAZY_HPP
+#define JSONPACK_LAZY_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <string.h>
+
+#include "jsonpack.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+class lazy_doc;
+
+/**
+ * Handle to a value of a lazy_doc, it is just a position in the json text.
+ * Looking up a missing key or index (or indexing a value that is not an
+ * object/array) gives an empty handle, malformed json found on the way
+ * throws invalid_json.
+ */
+class lazy_value
+{
+public:
+    lazy_value():
+        _doc(nullptr),
+        _pos(0)
+    {}
+
+    /**
+     * Member of an object
+     */
+    lazy_value operator[](const char* key) const
+    {
+        return find(key, strlen(key));
+    }
+
+    lazy_value operator[](const std::string &key) const
+    {
+        return find(key.data(), key.size());
+    }
+
+    /**
+     * Element of an array
+     */
+    lazy_value operator[](int index) const
+    {
+        return index < 0 ? lazy_value() : at( static_cast<std::size_t>(index) );
+    }
+
+    lazy_value operator[](std::size_t index) const
+    {
+        return at(index);
+    }
+
+    lazy_value find(const char* key, std::size_t len) const;
+
+    lazy_value at(std::size_t index) const;
+
+    /**
+     * The value is present in the document
+     */
+    bool exists() const
+    {
+        return _doc != nullptr;
+    }
+
+    explicit operator bool() const
+    {
+        return exists();
+    }
+
+    /**
+     * Token of the value: JTK_OPEN_KEY for objects, JTK_OPEN_BRACKET for
+     * arrays, the literal type otherwise and JTK_INVALID if empty
+     */
+    jsonpack_token_type type() const;
+
+    /**
+     * Number of members/elements, the whole object/array is scanned
+     */
+    std::size_t size() const;
+
+    /**
+     * Extract the value with the json_traits of T, objects and arrays are
+     * parsed here (and only this subtree). Throw type_error if the value is
+     * missing or its type does not match T.
+     */
+    template<typename T>
+    void get(T &out) const;
+
+    template<typename T>
+    T get() const
+    {
+        T out = T();
+        get(out);
+        return out;
+    }
+
+private:
+    friend class lazy_doc;
+
+    lazy_value(lazy_doc* doc, std::size_t pos):
+        _doc(doc),
+        _pos(pos)
+    {}
+
+    lazy_doc* _doc;
+    std::size_t _pos;   // first char of the value
+};
+
+/**
+ * Read only view of a JSON text that resolves doc["a"]["b"][3] by scanning
+ * forward only as far as needed. No tree is built: each object/array reached
+ * remembers the offsets of the members found so far, so later lookups resume
+ * the scan where the previous ones stopped, and the values passed over are
+ * skipped by bracket matching.
+ *
+ * The json text must outlive the document and the values taken from it.
+ * A lazy_doc caches state on lookups, it must not be shared between threads.
+ */
+class lazy_doc
+{
+public:
+    lazy_doc(const char* json, std::size_t len);
+
+    lazy_value root()
+    {
+        return lazy_value(this, _root);
+    }
+
+    lazy_value operator[](const char* key)
+    {
+        return root()[key];
+    }
+
+    lazy_value operator[](const std::string &key)
+    {
+        return root()[key];
+    }
+
+    lazy_value operator[](int index)
+    {
+        return root()[index];
+    }
+
+    lazy_value operator[](std::size_t index)
+    {
+        return root()[index];
+    }
+
+private:
+    friend class lazy_value;
+
+    /**
+     * Member of an object (key offsets) or element of an array
+     */
+    struct member
+    {
+        std::size_t _key;
+        std::size_t _key_len;
+        bool _escaped;
+        std::size_t _value;
+    };
+
+    /**
+     * Scan state of an object or array, by offset of its opening bracket
+     */
+    struct container
+    {
+        explicit container(std::size_t pos):
+            _scan(pos + 1),
+            _end(0),
+            _done(false),
+            _members()
+        {}
+
+        std::size_t _scan;  // end of the last member found
+        std::size_t _end;   // past the closing bracket, 0 if not known yet
+        bool _done;         // all the members are found
+        std::vector<member> _members;
+    };
+
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    jsonpack_token_type token_at(std::size_t pos);
+
+    container& container_at(std::size_t pos);
+
+    std::size_t container_end(std::size_t pos);
+
+    bool next_member(container &c, bool object);
+
+    bool key_equals(const member &m, const char* key, std::size_t len);
+
+    std::size_t find(std::size_t pos, const char* key, std::size_t len);
+
+    std::size_t at(std::size_t pos, std::size_t index);
+
+    std::size_t size(std::size_t pos);
+
+    /**
+     * Fill v with the value at pos, return the json pointer its positions
+     * are relative to
+     */
+    char* decode(std::size_t pos, jsonpack::value &v);
+
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    lazy_doc(const lazy_doc&) = delete ;
+    lazy_doc& operator=(const lazy_doc&) = delete ;
+#else
+    lazy_doc(const lazy_doc&) ;
+    lazy_doc& operator=(const lazy_doc&) ;
+#endif
+
+private:
+    const char* _json;
+    std::size_t _len;
+    std::size_t _root;
+
+    scanner _s;
+    parser _parser;     // objects and arrays requested by get()
+
+    std::unordered_map<std::size_t, container> _containers;
+    std::string _key;   // decoded escaped key
+};
+
+//---------------------------------------------------------------------------------------------------
+template<typename T>
+void lazy_value::get(T &out) const
+{
+    if(_doc == nullptr)
+        throw type_error("Missing value");
+
+    jsonpack::value v;
+    char* json_ptr = _doc->decode(_pos, v);
+
+    if( !jsonpack::type::json_traits<T&>::match_token_type(v) )
+        throw type_error("Invalid value type");
+
+    jsonpack::type::json_traits<T&>::extract(v, json_ptr, out);
+}
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_LAZY_HPP
@@ -29,7 +29,7 @@
 #include <xhash>
 #endif
 
-#include "jsonpack/namespace.hpp"
+#include "jsonpack/arena.hpp"
 
 JSONPACK_API_BEGIN_NAMESPACE
 
@@ -44,9 +44,7 @@ struct key
 
     bool operator== (const key &k1) const
     {
-        std::size_t min =  std::min( k1._bytes, _bytes );
-		bool ret = ( memcmp(k1._ptr, _ptr, min) == 0 );
-        return ret;
+        return k1._bytes == _bytes && memcmp(k1._ptr, _ptr, _bytes) == 0;
     }
 
     key():_ptr(nullptr), _bytes(0){}
@@ -104,21 +102,9 @@ enum jsonpack_token_type
 struct position
 {
     jsonpack_token_type _type;
+    bool _escaped;          // string literal containing backslash escapes
     unsigned long _pos;
     unsigned long _count;
-
-
-#ifndef _MSC_VER
-    position& operator =(const position &rvalue)
-    {
-        _type = rvalue._type;
-        _pos = rvalue._pos;
-        _count = rvalue._count;
-        return *this;
-    }
-
-#endif
-
 };
 
 
@@ -127,12 +113,13 @@ struct value;
 /**
  * Collection of key/value pairs (javascript object)
  */
-typedef std::unordered_map<key, value, key_hash >  object_t;
+typedef std::unordered_map<key, value, key_hash, std::equal_to<key>,
+                           arena_allocator< std::pair<const key, value> > >  object_t;
 
 /**
  * Sequence of values
  */
-typedef std::vector<value> array_t;
+typedef std::vector<value, arena_allocator<value> > array_t;
 
 /**
  * For union active field control
@@ -161,90 +148,35 @@ struct value
         object_t*  _obj;
         array_t*   _arr;
     };
-
-    value& operator =(const value &rv)
-    {
-        _field = rv._field;
-        switch (_field)
-        {
-        case _POS:
-            _pos = rv._pos;
-            break;
-        case _ARR:
-            _arr = rv._arr;
-            break;
-        default:
-            _obj = rv._obj;
-            break;
-        }
-
-        return *this;
-    }
 };
 
-//forward
-static inline void delete_object(object_t *obj);
-
 /**
- * Function to free array_t
+ * Create an empty object_t inside the arena, the object and all its elements
+ * are released with the arena, so it must not be deleted
  */
-static inline void delete_array(array_t *arr)
+static inline object_t* new_object(arena &a)
 {
-    for(array_t::iterator elem = arr->begin(); elem != arr->end(); elem++)
-    {
-        if((*elem)._field == _OBJ)
-        {
-            delete_object((*elem)._obj);
-        }
-        else if((*elem)._field == _ARR)
-        {
-            delete_array((*elem)._arr);
-        }
-    }
-
-    arr->clear();
-    delete arr;
-    arr = nullptr;
+    void* mem = a.allocate(sizeof(object_t), alignof(object_t));
+    return new (mem) object_t(0, key_hash(), std::equal_to<key>(), object_t::allocator_type(&a));
 }
 
 /**
- * Function to free object_t
+ * Create an empty array_t inside the arena, the array and all its elements
+ * are released with the arena, so it must not be deleted
  */
-static inline void delete_object(object_t *obj)
+static inline array_t* new_array(arena &a)
 {
-    for(object_t::iterator it = obj->begin(); it != obj->end(); it++)
-    {
-        if(it->second._field == _OBJ)
-        {
-            delete_object(it->second._obj);
-        }
-        else if(it->second._field == _ARR)
-        {
-            delete_array(it->second._arr);
-        }
-    }
-
-    obj->clear();
-    delete obj;
-    obj = nullptr;
+    void* mem = a.allocate(sizeof(array_t), alignof(array_t));
+    return new (mem) array_t(array_t::allocator_type(&a));
 }
 
 /**
- * Function to free internal elements
+ * Remove the elements of obj. Nested objects and arrays are owned by the
+ * arena of the parser that created them, see parser::reset()
  */
 static inline void clean_object(object_t & obj)
 {
-    for(object_t::iterator it = obj.begin(); it != obj.end(); it++)
-    {
-        if(it->second._field == _OBJ)
-        {
-            delete_object(it->second._obj);
-        }
-        else if(it->second._field == _ARR)
-        {
-            delete_array(it->second._arr);
-        }
-    }
+    obj.clear();
 }
 
 /*
@@ -0,0 +1,158 @@
+/**
+ *  Jsonpack - Parallel decoding of newline-delimited JSON
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_PARALLEL_HPP
+#define JSONPACK_PARALLEL_HPP
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+#include "jsonpack.hpp"
+#include "jsonpack/util/simd.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/**
+ * Span of a record in the NDJSON buffer
+ */
+struct record_span
+{
+    std::size_t _pos;
+    std::size_t _count;
+};
+
+/**
+ * Split a NDJSON buffer at record boundaries. Raw newlines cannot appear
+ * inside JSON strings, so every '\n' ends a record; blank lines are skipped.
+ */
+static inline void split_ndjson(const char* json, std::size_t len, std::vector<record_span> &records)
+{
+    const char* p = json;
+    const char* end = json + len;
+
+    while(p < end)
+    {
+        const char* nl = static_cast<const char*>( memchr(p, '\n', end - p) );
+        const char* stop = nl != nullptr ? nl : end;
+
+        const char* b = p;
+        while(b < stop && util::is_space(*b)) ++b;
+
+        if(b < stop)
+        {
+            record_span r;
+            r._pos = b - json;
+            r._count = stop - b;
+            records.push_back(r);
+        }
+
+        p = stop + 1;
+    }
+}
+
+/**
+ * Decode a NDJSON buffer (for example a mmap'd file) into a vector of
+ * DEFINE_JSON_ATTRIBUTES objects, keeping the input order.
+ *
+ * Records are handed out in small batches to a pool of workers, each one with
+ * its own parser; an idle worker takes the next pending batch, so slow records
+ * do not stall the others. The calling thread is one of the workers.
+ * If a record fails, the first error is rethrown once all workers stopped.
+ *
+ * threads = 0 uses std::thread::hardware_concurrency()
+ */
+template<typename T>
+inline void json_unpack_ndjson(const char* json, const std::size_t &len, std::vector<T> &out, unsigned threads = 0)
+{
+    std::vector<record_span> records;
+    split_ndjson(json, len, records);
+
+    out.clear();
+    out.resize(records.size());
+
+    if(threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if(threads == 0)
+        threads = 1;
+
+    const std::size_t batch = 64;
+    const std::size_t batches = (records.size() + batch - 1) / batch;
+    if(threads > batches)
+        threads = batches > 0 ? static_cast<unsigned>(batches) : 1;
+
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]()
+    {
+        parser p;
+        try
+        {
+            std::size_t b;
+            while( !failed.load(std::memory_order_relaxed) &&
+                   (b = next.fetch_add(1, std::memory_order_relaxed)) < batches )
+            {
+                std::size_t last = (b + 1) * batch < records.size() ? (b + 1) * batch : records.size();
+
+                for(std::size_t i = b * batch; i < last; ++i)
+                {
+                    out[i].json_unpack(json + records[i]._pos, records[i]._count, p);
+                }
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if( !failed.exchange(true) )
+                error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    try
+    {
+        pool.reserve(threads - 1);
+        for(unsigned t = 1; t < threads; ++t)
+            pool.push_back( std::thread(worker) );
+    }
+    catch(...) // the started workers must be joined before the pool goes away
+    {
+        failed.store(true);
+        for(std::size_t t = 0; t < pool.size(); ++t)
+            pool[t].join();
+        throw;
+    }
+
+    worker();
+
+    for(std::size_t t = 0; t < pool.size(); ++t)
+        pool[t].join();
+
+    if(error)
+        std::rethrow_exception(error);
+}
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_PARALLEL_HPP
@@ -20,6 +20,7 @@
 #define JSONPACK_JSON_PARSER
 
 #include <cctype>
+#include <string>
 #include <stdint.h>
 
 #include "jsonpack/object.hpp"
@@ -27,6 +28,7 @@
 
 JSONPACK_API_BEGIN_NAMESPACE
 
+class tape;
 
 /** ****************************************************************************
  ******************************** SCANNER **************************************
@@ -39,16 +41,28 @@ struct scanner
 
     void advance();
 
+    /**
+     * Move the scanner to the given position in json string
+     */
+    void advance_to(uint_fast32_t i);
+
     /**
      * Parse the current value in json string
      */
     jsonpack_token_type next();
 
     /**
-     * Parse a string literal
+     * Parse a string literal, the closing quote and the backslashes are searched
+     * in blocks of 16/32 bytes. In in-situ mode the escapes are decoded in place.
      */
     jsonpack_token_type string_literal();
 
+    /**
+     * Move past the end of the object or array opened by the bracket open,
+     * without parsing it
+     */
+    bool skip_container(char open);
+
     /**
      * Parse a other literal values like: TRUE, NULL
      */
@@ -77,6 +91,14 @@ struct scanner
     uint_fast32_t _start_token_pos = 0;
 
     char _c = '\0';
+
+    bool _escaped = false;  // last string literal has backslash escapes
+    uint_fast32_t _literal_end = 0;    // end of the last string literal content
+
+    bool _insitu = false;   // decode escapes in place in the json text
+
+    bool _validate_utf8 = false;
+    std::size_t _bad_utf8 = std::string::npos;  // offset of the first invalid UTF-8 sequence
 #else
     const char * _source ;
     uint_fast32_t _i ;
@@ -85,6 +107,14 @@ struct scanner
     uint_fast32_t _start_token_pos ;
 
     char _c;
+
+    bool _escaped;
+    uint_fast32_t _literal_end;
+
+    bool _insitu;
+
+    bool _validate_utf8;
+    std::size_t _bad_utf8;
 #endif
 
 
@@ -96,33 +126,156 @@ struct scanner
  *******************************************************************************/
 
 
+/**
+ * Parser options, they can be combined with '|'
+ */
+enum parser_flags
+{
+    PARSE_DEFAULT = 0,
+
+    /**
+     * Decode the escapes of the string literals (keys included) in place, so
+     * the json text must be writable and it is modified. Extracted strings
+     * then never need a decoding copy and escaped strings can be referenced
+     * by str_ref and std::string_view.
+     */
+    PARSE_INSITU = 1,
+
+    /**
+     * Reject string literals (keys included) that are not valid UTF-8, the
+     * check runs on each string span while it is scanned
+     */
+    PARSE_VALIDATE_UTF8 = 2,
+
+    /**
+     * Check the grammar of the values of unknown keys in json_decode, which
+     * otherwise skips them matching only their brackets
+     */
+    PARSE_VALIDATE_SKIPPED = 4
+};
+
+/**
+ * Receiver of the members of the top level object in a single pass typed
+ * decoding, see parser::json_decode
+ */
+struct object_visitor
+{
+    virtual ~object_visitor() {}
+
+    /**
+     * Member slot bound to the key, or -1 to skip the value
+     */
+    virtual int slot(const char* key, std::size_t len) = 0;
+
+    /**
+     * Decode the value of a bound member, nested objects and arrays are
+     * already parsed into the parser arena
+     */
+    virtual void member(int slot, const value &v) = 0;
+};
+
+/**
+ * Recursive descent parser. All the parsing state (current token, scanner and
+ * last error) lives in the instance, so each thread can use its own parser and
+ * decode documents concurrently without any shared mutable state.
+ * A parser instance can be reused for any number of documents, but it must not
+ * be used by two threads at the same time.
+ *
+ * Nested objects and arrays are allocated in the parser arena, they stay valid
+ * until reset() is called or the parser is destroyed.
+ */
 struct parser
 {
+    /**
+     * flags: combination of parser_flags
+     */
+    explicit parser(unsigned flags = PARSE_DEFAULT):
+        error_(),
+        _tk(JTK_INVALID),
+        _s(),
+        _arena(),
+        _validate_skipped((flags & PARSE_VALIDATE_SKIPPED) != 0)
+    {
+        _s._insitu = (flags & PARSE_INSITU) != 0;
+        _s._validate_utf8 = (flags & PARSE_VALIDATE_UTF8) != 0;
+    }
+
+    bool json_validate(const char *json, const std::size_t &len, object_t & members);
+    bool json_validate(const char *json,const std::size_t &len, array_t &elemets );
+
+    /**
+     * Parse a JSON object or array into a flat tape (see jsonpack/tape.hpp)
+     * instead of object_t/array_t containers
+     */
+    bool json_validate(const char *json, const std::size_t &len, tape &t);
+
+    /**
+     * Single pass decoding of a JSON object: each member is handed to the
+     * visitor as soon as it is parsed, no map of the top level object is
+     * built and the values of unknown keys are skipped without being parsed
+     * (only their brackets are matched, unless PARSE_VALIDATE_SKIPPED).
+     */
+    bool json_decode(const char *json, const std::size_t &len, object_visitor &visitor);
 
-    static bool json_validate(const char *json, const std::size_t &len, object_t & members);
-    static bool json_validate(const char *json,const std::size_t &len, array_t &elemets );
+    /**
+     * Release at once all the values created by previous json_validate calls
+     */
+    void reset();
+
+    /**
+     * Arena of the parsed values, used to create top level containers
+     * that share the lifetime of the nested ones
+     */
+    arena& get_arena()
+    {
+        return _arena;
+    }
+
+    /**
+     * Byte offset of the first invalid UTF-8 sequence found by the last
+     * json_validate call with PARSE_VALIDATE_UTF8, or std::string::npos
+     */
+    std::size_t utf8_error_offset() const
+    {
+        return _s._bad_utf8;
+    }
 
-    static std::string error_;
+    /**
+     * Description of the last parsing error
+     */
+    std::string error_;
 
 private:
-    static bool match(const jsonpack_token_type &token);
+    bool match(const jsonpack_token_type &token);
+
+    void advance();
+
+    void utf8_error();
+
+    bool item_list(object_t &members);
+
+    bool item(object_t &members);
+
+    bool value(key k, object_t &members);
 
-    static void advance();
+    bool value(array_t &elemets);
 
+    bool any_value(jsonpack::value &val);
 
-    static bool item_list(object_t &members);
+    bool skip_value();
 
-    static bool item(object_t &members);
+    bool decode_members(object_visitor &visitor);
 
-    static bool value(key k, object_t &members);
+    bool tape_value(tape &t);
 
-    static bool value(array_t &elemets);
+    bool array_list(array_t &elemets);
 
-    static bool array_list(array_t &elemets);
 
+    jsonpack_token_type _tk;
+    scanner _s;
+    arena _arena;
 
-    static jsonpack_token_type _tk;
-    static scanner _s;
+    bool _validate_skipped;
 
 };
 
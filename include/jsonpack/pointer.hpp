@@ -0,0 +1,310 @@
+/**
+ *  Jsonpack - JSON Pointer queries over parsed values
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_POINTER_HPP
+#define JSONPACK_POINTER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "jsonpack.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/**
+ * Compiled path to a value inside a parsed document. The path is parsed and
+ * its keys hashed once, then it can be evaluated against any number of
+ * documents. Two syntaxes are accepted:
+ *
+ * - RFC 6901 JSON Pointer: "/a/b/0", "~0" stands for '~' and "~1" for '/',
+ *   the empty pointer "" is the whole document
+ * - dotted path: "a.b[0].c", a numeric segment is an array index too
+ *
+ * Keys are compared with the keys of the parsed text as they are, the
+ * escapes in the json keys are decoded only when parsing with PARSE_INSITU.
+ * Throw invalid_pointer on a malformed path.
+ */
+class json_pointer
+{
+public:
+    explicit json_pointer(const char* path);
+
+    explicit json_pointer(const std::string &path);
+
+    /**
+     * Value pointed by the path or nullptr if missing. The roots from
+     * parser::json_validate resolve non empty paths only.
+     */
+    const value* find(const value &root) const;
+
+    const value* find(const object_t &root) const;
+
+    const value* find(const array_t &root) const;
+
+    /**
+     * Extract the pointed value with the json_traits of T, json_ptr is the
+     * text the document was parsed from. Return false if the value is
+     * missing, throw type_error if its type does not match T.
+     */
+    template<typename T, typename Root>
+    bool get(const Root &root, char* json_ptr, T &out) const
+    {
+        const value* v = find(root);
+        if(v == nullptr)
+            return false;
+
+        if( !type::json_traits<T&>::match_token_type(*v) )
+        {
+            std::string msg = "Invalid value type for pointer: ";
+            msg.append(_path);
+            throw type_error( msg.data() );
+        }
+
+        type::json_traits<T&>::extract(*v, json_ptr, out);
+        return true;
+    }
+
+    /**
+     * Number of reference tokens
+     */
+    std::size_t size() const
+    {
+        return _tokens.size();
+    }
+
+    const std::string& path() const
+    {
+        return _path;
+    }
+
+private:
+    friend class path_set;
+
+    /**
+     * Reference token, a member name and its array index if it is one
+     */
+    struct token
+    {
+        token(const std::string &name, std::size_t hash, std::size_t index):
+            _name(name),
+            _hash(hash),
+            _index(index)
+        {}
+
+        std::string _name;
+        std::size_t _hash;
+        std::size_t _index;     // npos if not a valid index
+    };
+
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    void compile();
+
+    void parse_pointer();
+
+    void parse_dotted();
+
+    void add_token(const std::string &name);
+
+    /**
+     * Follow the tokens from first on, starting at the given container
+     */
+    const value* walk(const value* v, std::size_t first) const;
+
+    const value* member(const object_t &obj, const token &t) const;
+
+    const value* element(const array_t &arr, const token &t) const;
+
+    std::string _path;
+    std::vector<token> _tokens;
+};
+
+/**
+ * Destination of a path_set query
+ */
+struct path_target
+{
+    virtual ~path_target() {}
+
+    virtual bool match_token_type(const value &v) const = 0;
+
+    virtual void extract(const value &v, char* json_ptr) = 0;
+};
+
+template<typename T>
+struct typed_path_target : public path_target
+{
+    explicit typed_path_target(T &out):
+        _out(out)
+    {}
+
+    bool match_token_type(const value &v) const
+    {
+        return type::json_traits<T&>::match_token_type(v);
+    }
+
+    void extract(const value &v, char* json_ptr)
+    {
+        type::json_traits<T&>::extract(v, json_ptr, _out);
+    }
+
+    T &_out;
+};
+
+/**
+ * Set of paths extracted together in a single forward scan of the json
+ * text, without building the document. The paths are merged in a tree, so
+ * at each object/array only the members on the way to some target are
+ * visited, the others are skipped by bracket matching; a container whose
+ * targets are all found is skipped to its end and the scan stops as soon as
+ * every target is filled.
+ *
+ * Usage:
+ *   jsonpack::path_set paths;
+ *   paths.add("/user/id", id);
+ *   paths.add("event.tags[0]", tag);
+ *   paths.extract(json, len);    // once per document
+ *
+ * Targets are extracted through json_traits<T&>, objects and arrays by
+ * parsing their subtree only. A path_set keeps the scanning state, it must
+ * not be used by two threads at the same time.
+ */
+class path_set
+{
+public:
+    path_set();
+
+    /**
+     * Extract the value at path into out, which must outlive the set
+     */
+    template<typename T>
+    void add(const json_pointer &path, T &out)
+    {
+        add_target(path, new typed_path_target<T>(out));
+    }
+
+    template<typename T>
+    void add(const char* path, T &out)
+    {
+        add( json_pointer(path), out );
+    }
+
+    /**
+     * Fill the targets found in json, return how many they are. The targets
+     * of missing paths are left untouched. Throw invalid_json on malformed
+     * json met by the scan, type_error if a value does not match its target.
+     */
+    std::size_t extract(const char* json, const std::size_t &len);
+
+    /**
+     * The i-th added path was found by the last extract
+     */
+    bool found(std::size_t i) const
+    {
+        return _targets[i]._found;
+    }
+
+    std::size_t size() const
+    {
+        return _targets.size();
+    }
+
+private:
+    /**
+     * Node of the path tree, the root is the node 0
+     */
+    struct node
+    {
+        node(std::size_t parent, const std::string &name, std::size_t index):
+            _parent(parent),
+            _name(name),
+            _index(index),
+            _children(),
+            _targets(),
+            _total(0)
+        {}
+
+        std::size_t _parent;
+        std::string _name;          // reference token reaching the node
+        std::size_t _index;
+        std::vector<std::size_t> _children;
+        std::vector<std::size_t> _targets;
+        std::size_t _total;         // targets in the subtree
+    };
+
+    struct target
+    {
+        target(const std::string &path, path_target* dest):
+            _path(path),
+            _dest(dest),
+            _found(false)
+        {}
+
+        std::string _path;
+        std::shared_ptr<path_target> _dest;
+        bool _found;
+    };
+
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    void add_target(const json_pointer &path, path_target* dest);
+
+    /**
+     * Child of the node reached by the key or index just scanned, or npos
+     */
+    std::size_t child_for_key(const node &n, const char* key, std::size_t len, bool escaped);
+
+    std::size_t child_for_index(const node &n, std::size_t index);
+
+    /**
+     * Process the value whose token tk was just read, return false once
+     * all the targets are found
+     */
+    bool scan_value(std::size_t id, jsonpack_token_type tk);
+
+    bool scan_container(std::size_t id, bool object);
+
+    void skip_value(jsonpack_token_type tk);
+
+    void fill(std::size_t id, jsonpack_token_type tk, std::size_t start);
+
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    path_set(const path_set&) = delete ;
+    path_set& operator=(const path_set&) = delete ;
+#else
+    path_set(const path_set&) ;
+    path_set& operator=(const path_set&) ;
+#endif
+
+    std::vector<node> _nodes;
+    std::vector<target> _targets;
+
+    std::vector<std::size_t> _pending;  // targets not found yet per node subtree
+    std::size_t _remaining;
+
+    const char* _json;
+    scanner _s;
+    parser _parser;     // objects and arrays extracted into targets
+    std::string _key;   // decoded escaped key
+};
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_POINTER_HPP
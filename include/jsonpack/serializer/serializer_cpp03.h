@@ -24,10 +24,44 @@
 JSONPACK_API_BEGIN_NAMESPACE
 
 
+////============================== JSON_SIZE ==============================================
+/**
+ * Adds up the sizes of the attributes listed after it with the comma
+ * operator, (size_counter(), a, b, c).object_size(keys) is the exact size of
+ * the object written by make_json, nothing is written
+ */
+struct size_counter
+{
+    size_counter():
+        _size(0),
+        _count(0)
+    {}
+
+    template <typename T>
+    size_counter& operator,(const T& v)
+    {
+        _size += type::json_traits<T>::size(v);
+        _count++;
+        return *this;
+    }
+
+    /**
+     * keys are the comma separated attribute names
+     */
+    std::size_t object_size(const std::string &keys) const
+    {
+        // "{" + "\"key\":" per attribute (names without their commas) + "}" for the last comma
+        return _size + keys.size() + 2 * _count + 2;
+    }
+
+    std::size_t _size;
+    std::size_t _count;
+};
+
 ////============================== MAKE_JSON ==============================================
 // 1 parameter
-template <typename T>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v)
 {
     register std::string::size_type pos = keys.find(',');
@@ -35,12 +69,12 @@ static inline void make_json(buffer &json, const std::string &keys,
     type::json_traits<T>::append(json, keys.substr(0, pos).c_str() , v);
 
     json.erase_last_comma();
-    json.append("}\0", 2);
+    json.append("}", 1);
 }
 
 // 2 parameters
-template <typename T, typename T1>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1)
 {
     register std::string::size_type pos = keys.find(',');
@@ -51,8 +85,8 @@ static inline void make_json(buffer &json, const std::string &keys,
 }
 
 // 3 parameters
-template <typename T, typename T1, typename T2>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1, typename T2>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2)
 {
     register std::string::size_type pos = keys.find(',');
@@ -62,8 +96,8 @@ static inline void make_json(buffer &json, const std::string &keys,
               v1, v2);
 }
 // 4 parameters
-template <typename T, typename T1, typename T2, typename T3>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1, typename T2, typename T3>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3)
 {
     register std::string::size_type pos = keys.find(',');
@@ -73,8 +107,8 @@ static inline void make_json(buffer &json, const std::string &keys,
               v1, v2, v3);
 }
 // 5 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4)
 {
     register std::string::size_type pos = keys.find(',');
@@ -84,8 +118,8 @@ static inline void make_json(buffer &json, const std::string &keys,
               v1, v2, v3, v4);
 }
 // 6 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5)
 {
     register std::string::size_type pos = keys.find(',');
@@ -95,8 +129,8 @@ static inline void make_json(buffer &json, const std::string &keys,
               v1, v2, v3, v4, v5);
 }
 // 7 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6)
 {
     register std::string::size_type pos = keys.find(',');
@@ -106,8 +140,8 @@ static inline void make_json(buffer &json, const std::string &keys,
               v1, v2, v3, v4, v5, v6);
 }
 // 8 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7)
 {
     register std::string::size_type pos = keys.find(',');
@@ -117,8 +151,8 @@ static inline void make_json(buffer &json, const std::string &keys,
               v1, v2, v3, v4, v5, v6, v7);
 }
 // 9 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8>
-static inline void make_json(buffer &json, const std::string &keys,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8>
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7, const T8& v8)
 {
     register std::string::size_type pos = keys.find(',');
@@ -128,9 +162,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v1, v2, v3, v4, v5, v6, v7, v8);
 }
 // 10 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9)
 {
@@ -142,9 +176,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9);
 }
 // 11 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10)
 {
@@ -156,9 +190,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10);
 }
 // 12 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11)
 {
@@ -170,9 +204,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10, v11);
 }
 // 13 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12)
 {
@@ -184,9 +218,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10, v11, v12);
 }
 // 14 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13)
 {
@@ -198,9 +232,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10, v11, v12, v13);
 }
 // 15 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14)
 {
@@ -212,9 +246,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10, v11, v12, v13, v14);
 }
 // 16 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15)
 {
@@ -226,9 +260,9 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10, v11, v12, v13, v14, v15);
 }
 // 17 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15, typename T16>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15, const T16& v16)
 {
@@ -240,10 +274,10 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10, v11, v12, v13, v14, v15, v16);
 }
 // 18 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17)
@@ -256,10 +290,10 @@ static inline void make_json(buffer &json, const std::string &keys,
               v9, v10, v11, v12, v13, v14, v15, v16, v17);
 }
 // 19 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18)
@@ -273,10 +307,10 @@ static inline void make_json(buffer &json, const std::string &keys,
               v17, v18);
 }
 // 20 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19)
@@ -290,10 +324,10 @@ static inline void make_json(buffer &json, const std::string &keys,
               v17, v18, v19);
 }
 // 21 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20)
@@ -307,10 +341,10 @@ static inline void make_json(buffer &json, const std::string &keys,
               v17, v18, v19, v20);
 }
 // 22 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21)
@@ -324,10 +358,10 @@ static inline void make_json(buffer &json, const std::string &keys,
               v17, v18, v19, v20, v21);
 }
 // 23 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22)
@@ -341,10 +375,10 @@ static inline void make_json(buffer &json, const std::string &keys,
               v17, v18, v19, v20, v21, v22);
 }
 // 24 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23)
@@ -358,11 +392,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v17, v18, v19, v20, v21, v22, v23);
 }
 // 25 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
@@ -377,11 +411,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v17, v18, v19, v20, v21, v22, v23, v24);
 }
 // 26 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24, typename T25>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
@@ -397,11 +431,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v25);
 }
 // 27 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24, typename T25, typename T26>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
@@ -417,11 +451,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v25, v26);
 }
 // 28 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24, typename T25, typename T26, typename T27>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
@@ -437,11 +471,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v25, v26, v27);
 }
 // 29 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24, typename T25, typename T26, typename T27, typename T28>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
@@ -457,11 +491,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v25, v26, v27, v28);
 }
 // 30 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24, typename T25, typename T26, typename T27, typename T28, typename T29>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
@@ -477,11 +511,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v25, v26, v27, v28, v29);
 }
 // 31 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24, typename T25, typename T26, typename T27, typename T28, typename T29, typename T30>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
@@ -497,11 +531,11 @@ static inline void make_json(buffer &json, const std::string &keys,
               v25, v26, v27, v28, v29, v30);
 }
 // 32 parameters
-template <typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
+template <typename Sink, typename T, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7,
           typename T8, typename T9, typename T10, typename T11, typename T12, typename T13, typename T14, typename T15,
           typename T16, typename T17, typename T18, typename T19, typename T20, typename T21, typename T22, typename T23,
           typename T24, typename T25, typename T26, typename T27, typename T28, typename T29, typename T30, typename T31>
-static inline void make_json(buffer &json, const std::string &keys,
+static inline void make_json(Sink &json, const std::string &keys,
                              const T& v, const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7,
                              const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15,
                              const T16& v16, const T17& v17, const T18& v18, const T19& v19, const T20& v20, const T21& v21, const T22& v22, const T23& v23,
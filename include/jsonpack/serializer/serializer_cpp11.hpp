@@ -19,44 +19,150 @@
 #ifndef JSONPACK_SERIALIZER_CPP11_HPP
 #define JSONPACK_SERIALIZER_CPP11_HPP
 
+#include <tuple>
+
+#include "jsonpack/parser.hpp"
 #include "jsonpack/types.hpp"
+#include "jsonpack/util/key_table.hpp"
 
 JSONPACK_API_BEGIN_NAMESPACE
 
 
 ////============================== MAKE_JSON ==============================================
-
-static inline void make_json(buffer &json, const std::string &UNUSED(key) )
+/**
+ * Names is the type holding the stringified attribute names, see util::json_key
+ */
+template <typename Names, std::size_t I, typename Sink>
+static inline void make_json(Sink &json)
 {
     json.erase_last_comma();
-    json.append("}\0", 2);
+    json.append("}", 1);
 }
 
-template <typename T, typename ...Types >
-static inline void make_json(buffer &json, const std::string &keys, const T& val, const Types& ...values )
+template <typename Names, std::size_t I = 0, typename Sink, typename T, typename ...Types >
+static inline void make_json(Sink &json, const T& val, const Types& ...values )
 {
-    register std::string::size_type pos = keys.find(',');
+    typedef typename util::json_key<Names, I>::quoted key;
 
-    type::json_traits<T>::append(json, keys.substr(0, pos).c_str() , val);
+    json.append(key::data, key::size);              // "key":
+    type::json_traits<T>::append(json, val);        // value,
 
-    make_json(json, keys.substr(pos+1, keys.length()-1 ).c_str() ,values...);
+    make_json<Names, I + 1>(json, values...);
 }
 
-////============================== MAKE_OBJECT ==============================================
-static inline void make_object(const object_t &UNUSED(json), char* UNUSED(json_ptr), const std::string &UNUSED(key) )
+////============================== JSON_SIZE ==============================================
+/**
+ * Exact size of the object written by json_append, nothing is written
+ */
+template <typename Names, std::size_t I>
+static inline std::size_t json_size()
 {
+    return 1;   // "{" and the "}" replacing the last comma
 }
 
-template <typename T, typename ...Types >
-static inline void make_object(const object_t &json_obj, char* json_ptr, const std::string &keys, T &val, Types& ...values )
+template <typename Names, std::size_t I = 0, typename T, typename ...Types >
+static inline std::size_t json_size(const T& val, const Types& ...values )
 {
-    std::string::size_type pos = keys.find(',');
+    typedef typename util::json_key<Names, I>::quoted key;
 
-    std::string current_key = keys.substr(0, pos);
+    return key::size + type::json_traits<T>::size(val) + json_size<Names, I + 1>(values...);
+}
 
-    type::json_traits<T&>::extract(json_obj, json_ptr, current_key.c_str(), current_key.length(), val);
+////============================== MAKE_OBJECT ==============================================
+template <typename Names, std::size_t I>
+static inline void extract_member(int UNUSED(slot), const value &UNUSED(v), char* UNUSED(json_ptr) )
+{
+}
 
-    make_object(json_obj, json_ptr, keys.substr(pos+1, keys.length()-1 ).c_str(), values...);
+/**
+ * Extract v into the attribute of index slot
+ */
+template <typename Names, std::size_t I = 0, typename T, typename ...Types >
+static inline void extract_member(int slot, const value &v, char* json_ptr, T &val, Types& ...values )
+{
+    if(slot == static_cast<int>(I))
+    {
+        if( type::json_traits<T&>::match_token_type(v) )
+        {
+            type::json_traits<T&>::extract(v, json_ptr, val);
+        }
+        else // the keyed extract reports the type error
+        {
+            typedef util::json_key<Names, I> name;
+
+            key k;
+            k._ptr = name::name();
+            k._bytes = name::length;
+
+            object_t single;
+            single[k] = v;
+            type::json_traits<T&>::extract(single, json_ptr, name::name(), name::length, val);
+        }
+        return;
+    }
+
+    extract_member<Names, I + 1>(slot, v, json_ptr, values...);
+}
+
+/**
+ * Walk the parsed members once, each key is mapped to its attribute by the
+ * compile time perfect hash of the names instead of a map lookup per attribute
+ */
+template <typename Names, typename ...Types >
+static inline void make_object(const object_t &json_obj, char* json_ptr, Types& ...values )
+{
+    typedef util::key_dispatch<Names, sizeof...(Types)> dispatch;
+
+    for(object_t::const_iterator it = json_obj.begin(); it != json_obj.end(); ++it)
+    {
+        int slot = dispatch::find(it->first._ptr, it->first._bytes);
+        if(slot >= 0)
+            extract_member<Names>(slot, it->second, json_ptr, values...);
+    }
+}
+
+////============================== OBJECT_DECODER ==============================================
+/**
+ * Visitor of parser::json_decode filling the attributes of a bound type
+ * while the json text is parsed
+ */
+template <typename Names, typename ...Types >
+class object_decoder : public object_visitor
+{
+public:
+    object_decoder(char* json_ptr, Types& ...values):
+        _json_ptr(json_ptr),
+        _values(values...)
+    {}
+
+    object_decoder(const object_decoder &) = default;
+    object_decoder& operator=(const object_decoder &) = delete;
+
+    int slot(const char* key, std::size_t len)
+    {
+        return util::key_dispatch<Names, sizeof...(Types)>::find(key, len);
+    }
+
+    void member(int slot, const value &v)
+    {
+        member(slot, v, typename util::make_index_sequence<sizeof...(Types)>::type());
+    }
+
+private:
+    template<std::size_t... I>
+    void member(int slot, const value &v, util::index_sequence<I...>)
+    {
+        extract_member<Names>(slot, v, _json_ptr, std::get<I>(_values)...);
+    }
+
+    char* _json_ptr;
+    std::tuple<Types&...> _values;
+};
+
+template <typename Names, typename ...Types >
+static inline object_decoder<Names, Types...> make_decoder(char* json_ptr, Types& ...values)
+{
+    return object_decoder<Names, Types...>(json_ptr, values...);
 }
 
 JSONPACK_API_END_NAMESPACE //jsonpack namespace
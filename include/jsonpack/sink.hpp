@@ -0,0 +1,478 @@
+/**
+ *  Jsonpack - Output sinks for the serializer
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_SINK_HPP
+#define JSONPACK_SINK_HPP
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+#include "jsonpack/buffer.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/**
+ * The serializer (json_append, json_traits<T>::append, json_append_sequence)
+ * writes to any Sink with the two members of jsonpack::buffer:
+ *
+ *   void append(const char* data, std::size_t len);
+ *   void erase_last_comma();   // drop the last byte if it is a ','
+ *
+ * erase_last_comma is called right after a value ending in ',' is appended,
+ * so a sink writing its output away must keep at least its last byte until
+ * more data comes. jsonpack::buffer is the growable sink, the ones below
+ * write into a fixed span, a file or a list of blocks for writev.
+ */
+
+/**
+ * Sink writing into a caller provided array. The output past the capacity
+ * is dropped but still counted, size() is the length of the whole json.
+ */
+class span_sink
+{
+public:
+    span_sink(char* data, std::size_t capacity):
+        _data(data),
+        _capacity(capacity),
+        _size(0),
+        _last('\0')
+    {}
+
+    void append(const char* data, std::size_t len)
+    {
+        if(len == 0)
+            return;
+
+        if(_size < _capacity)
+            memcpy(_data + _size, data, (len < _capacity - _size) ? len : _capacity - _size);
+
+        _size += len;
+        _last = data[len - 1];
+    }
+
+    void erase_last_comma()
+    {
+        if(_size > 0 && _last == ',')
+        {
+            _size--;
+            _last = (_size > 0 && _size <= _capacity) ? _data[_size - 1] : '\0';
+        }
+    }
+
+    /**
+     * Length of the output, truncated if it is greater than capacity()
+     */
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    std::size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    bool truncated() const
+    {
+        return _size > _capacity;
+    }
+
+    /**
+     * NUL terminate as snprintf does, at size() or at capacity() - 1 if the
+     * output does not fit. Return size().
+     */
+    std::size_t terminate()
+    {
+        if(_capacity > 0)
+            _data[_size < _capacity ? _size : _capacity - 1] = '\0';
+
+        return _size;
+    }
+
+private:
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    span_sink(const span_sink&) = delete ;
+    span_sink& operator=(const span_sink&) = delete ;
+#else
+    span_sink(const span_sink&) ;
+    span_sink& operator=(const span_sink&) ;
+#endif
+
+    char* _data;
+    std::size_t _capacity;
+    std::size_t _size;
+    char _last;         // last byte, also when it is past the capacity
+};
+
+/**
+ * Write len bytes of data, throw io_error on failure
+ */
+typedef std::function<void (const char* data, std::size_t len)> write_callback;
+
+/**
+ * Sink writing to a file or socket through a chunk buffer of bounded size,
+ * so a large document is never held in memory as a whole. Data bigger than
+ * the chunk is written directly. The output is complete after flush(), the
+ * destructor flushes what is left ignoring the errors.
+ *
+ * Usage:
+ *   jsonpack::stream_sink out(fd);
+ *   obj.json_append(out);
+ *   out.flush();
+ */
+class stream_sink
+{
+public:
+    /**
+     * Write to a POSIX file descriptor, it is not closed by the sink
+     */
+    explicit stream_sink(int fd, std::size_t chunk_size = 65536);
+
+    /**
+     * Write to a stdio stream, it is not closed by the sink
+     */
+    explicit stream_sink(FILE* file, std::size_t chunk_size = 65536);
+
+    /**
+     * Write through a user callback
+     */
+    explicit stream_sink(const write_callback &write, std::size_t chunk_size = 65536);
+
+    ~stream_sink();
+
+    void append(const char* data, std::size_t len)
+    {
+        if(len <= _capacity - _size)
+        {
+            memcpy(_data + _size, data, len);
+            _size += len;
+        }
+        else
+        {
+            spill(data, len);
+        }
+    }
+
+    void erase_last_comma()
+    {
+        if(_size > 0 && _data[_size - 1] == ',')
+            _size--;
+    }
+
+    /**
+     * Write the pending bytes, throw io_error on failure
+     */
+    void flush();
+
+    /**
+     * Bytes written so far, the pending ones included
+     */
+    std::size_t size() const
+    {
+        return _written + _size;
+    }
+
+private:
+    /**
+     * Write the chunk and data but its last byte, which stays pending
+     */
+    void spill(const char* data, std::size_t len);
+
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    stream_sink(const stream_sink&) = delete ;
+    stream_sink& operator=(const stream_sink&) = delete ;
+#else
+    stream_sink(const stream_sink&) ;
+    stream_sink& operator=(const stream_sink&) ;
+#endif
+
+    write_callback _write;
+    FILE* _file;            // flushed by flush() too
+
+    char* _data;
+    std::size_t _capacity;
+    std::size_t _size;
+    std::size_t _written;
+};
+
+#ifndef _WIN32
+typedef struct ::iovec io_vec;
+#else
+struct io_vec
+{
+    void* iov_base;
+    std::size_t iov_len;
+};
+#endif
+
+/**
+ * Sink collecting the output in fixed size blocks, which are never moved
+ * once allocated, described by a scatter-gather list for writev/sendmsg.
+ * Nothing is copied when the output grows and the blocks are reused by
+ * clear().
+ *
+ * String runs without escapes of ref_threshold bytes or more are not copied,
+ * the list references them in the serialized object: the object must stay
+ * alive and unchanged until the output is written. Punctuation, keys,
+ * numbers and short strings are packed into the blocks.
+ *
+ * Usage:
+ *   jsonpack::iovec_sink out;
+ *   obj.json_append(out);
+ *   out.write_to(fd);       // or ::writev(fd, out.iov(), out.iov_count())
+ */
+class iovec_sink
+{
+public:
+    /**
+     * ref_threshold = copy_all copies every string into the blocks
+     */
+    static const std::size_t copy_all = static_cast<std::size_t>(-1);
+
+    explicit iovec_sink(std::size_t block_size = 65536, std::size_t ref_threshold = 2048);
+
+    ~iovec_sink();
+
+    void append(const char* data, std::size_t len)
+    {
+        _size += len;
+
+        while(len > 0)
+        {
+            if(_used == _block_size)
+                next_block();
+
+            std::size_t n = (len < _block_size - _used) ? len : _block_size - _used;
+            memcpy(_blocks[_current] + _used, data, n);
+            _used += n;
+            data += n;
+            len -= n;
+        }
+    }
+
+    /**
+     * Append data that stays valid and unchanged until the output is
+     * written, referenced in place if it is long enough
+     */
+    void reference(const char* data, std::size_t len)
+    {
+        if(len < _ref_threshold)
+        {
+            append(data, len);
+            return;
+        }
+
+        end_segment();
+
+        io_vec v;
+        v.iov_base = const_cast<char*>(data);
+        v.iov_len = len;
+        _iov.push_back(v);
+        _size += len;
+    }
+
+    /**
+     * The last byte is only dropped while it is in the open segment, which
+     * is always the case after a ',' appended by the serializer
+     */
+    void erase_last_comma()
+    {
+        if(_used > _segment && _blocks[_current][_used - 1] == ',')
+        {
+            _used--;
+            _size--;
+        }
+    }
+
+    /**
+     * Drop the output, the blocks are kept for the next one
+     */
+    void clear();
+
+    /**
+     * Total length of the output
+     */
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Scatter-gather list of the output, valid until the next append
+     */
+    const io_vec* iov();
+
+    int iov_count();
+
+    /**
+     * Write the whole output to a POSIX file descriptor with writev, throw
+     * io_error on failure
+     */
+    void write_to(int fd);
+
+private:
+    void next_block();
+
+    /**
+     * Add the bytes of the current block not listed yet to the list
+     */
+    void end_segment();
+
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    iovec_sink(const iovec_sink&) = delete ;
+    iovec_sink& operator=(const iovec_sink&) = delete ;
+#else
+    iovec_sink(const iovec_sink&) ;
+    iovec_sink& operator=(const iovec_sink&) ;
+#endif
+
+    std::size_t _block_size;
+    std::size_t _ref_threshold;
+    std::vector<char*> _blocks;
+    std::size_t _current;       // block being filled, the previous ones are full
+    std::size_t _used;          // bytes used in the current block
+    std::size_t _segment;       // start of the bytes of the current block not listed yet
+    std::size_t _size;
+
+    std::vector<io_vec> _iov;
+};
+
+/**
+ * Sink operations beyond append and erase_last_comma, specialized by the
+ * sinks supporting them
+ */
+template<typename Sink>
+struct sink_traits
+{
+    /**
+     * Append data that stays valid and unchanged until the output is written
+     */
+    static void append_stable(Sink &json, const char* data, std::size_t len)
+    {
+        json.append(data, len);
+    }
+};
+
+template<>
+struct sink_traits<iovec_sink>
+{
+    static void append_stable(iovec_sink &json, const char* data, std::size_t len)
+    {
+        json.reference(data, len);
+    }
+};
+
+/**
+ * Reference to any sink through a plain class, taken by the json_append
+ * member of the bound types (a member template could not be declared in a
+ * function local class). Each append is an indirect call, jsonpack::buffer
+ * has its own json_append member without it.
+ */
+class sink_ref
+{
+public:
+    template<typename Sink>
+    sink_ref(Sink &json):
+        _sink(&json),
+        _append(&append_to<Sink>),
+        _append_stable(&append_stable_to<Sink>),
+        _erase_last_comma(&erase_last_comma_of<Sink>)
+    {}
+
+    sink_ref(const sink_ref &other):
+        _sink(other._sink),
+        _append(other._append),
+        _append_stable(other._append_stable),
+        _erase_last_comma(other._erase_last_comma)
+    {}
+
+    sink_ref(sink_ref &other):     // a copy, not a reference to other
+        _sink(other._sink),
+        _append(other._append),
+        _append_stable(other._append_stable),
+        _erase_last_comma(other._erase_last_comma)
+    {}
+
+    void append(const char* data, std::size_t len)
+    {
+        _append(_sink, data, len);
+    }
+
+    void append_stable(const char* data, std::size_t len)
+    {
+        _append_stable(_sink, data, len);
+    }
+
+    void erase_last_comma()
+    {
+        _erase_last_comma(_sink);
+    }
+
+private:
+    template<typename Sink>
+    static void append_to(void* sink, const char* data, std::size_t len)
+    {
+        static_cast<Sink*>(sink)->append(data, len);
+    }
+
+    template<typename Sink>
+    static void append_stable_to(void* sink, const char* data, std::size_t len)
+    {
+        sink_traits<Sink>::append_stable(*static_cast<Sink*>(sink), data, len);
+    }
+
+    template<typename Sink>
+    static void erase_last_comma_of(void* sink)
+    {
+        static_cast<Sink*>(sink)->erase_last_comma();
+    }
+
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    sink_ref& operator=(const sink_ref&) = delete ;
+#else
+    sink_ref& operator=(const sink_ref&) ;
+#endif
+
+    void* _sink;
+    void (*_append)(void*, const char*, std::size_t);
+    void (*_append_stable)(void*, const char*, std::size_t);
+    void (*_erase_last_comma)(void*);
+};
+
+template<>
+struct sink_traits<sink_ref>
+{
+    static void append_stable(sink_ref &json, const char* data, std::size_t len)
+    {
+        json.append_stable(data, len);
+    }
+};
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_SINK_HPP
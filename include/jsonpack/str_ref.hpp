@@ -0,0 +1,116 @@
+/**
+ *  Jsonpack - Non owning reference to a string in the json text
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_STR_REF_HPP
+#define JSONPACK_STR_REF_HPP
+
+#include <string>
+#include <string.h>
+
+#include "jsonpack/namespace.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/**
+ * String member decoded without copy: it points straight into the json text,
+ * which must outlive the object. Only a string with escapes, which can not be
+ * referenced as is, is decoded into an owned copy.
+ * A null reference (data() == nullptr) is packed as JSON null.
+ */
+class str_ref
+{
+public:
+    str_ref(): _ptr(nullptr), _len(0), _owned() {}
+
+    str_ref(const char* str): _ptr(str), _len(str != nullptr ? strlen(str) : 0), _owned() {}
+
+    str_ref(const char* str, std::size_t len): _ptr(str), _len(len), _owned() {}
+
+    str_ref(const str_ref &other):
+        _ptr(other._ptr),
+        _len(other._len),
+        _owned(other._owned)
+    {
+        if(other.owns())
+            _ptr = _owned.data();
+    }
+
+    str_ref& operator=(const str_ref &other)
+    {
+        if(this != &other)
+        {
+            _owned = other._owned;
+            _ptr = other.owns() ? _owned.data() : other._ptr;
+            _len = other._len;
+        }
+        return *this;
+    }
+
+    /**
+     * Reference the given text
+     */
+    void assign(const char* str, std::size_t len)
+    {
+        _owned.clear();
+        _ptr = str;
+        _len = len;
+    }
+
+    /**
+     * Keep a copy of the given text
+     */
+    void assign_copy(const char* str, std::size_t len)
+    {
+        _owned.assign(str, len);
+        _ptr = _owned.data();
+        _len = len;
+    }
+
+    const char* data() const { return _ptr; }
+
+    std::size_t size() const { return _len; }
+
+    std::size_t length() const { return _len; }
+
+    bool empty() const { return _len == 0; }
+
+    /**
+     * True when the text is an owned copy instead of a reference
+     */
+    bool owns() const { return _ptr != nullptr && _ptr == _owned.data(); }
+
+    std::string str() const { return std::string(_ptr != nullptr ? _ptr : "", _len); }
+
+    char operator[](std::size_t i) const { return _ptr[i]; }
+
+    bool operator==(const str_ref &other) const
+    {
+        return _len == other._len && (_len == 0 || memcmp(_ptr, other._ptr, _len) == 0);
+    }
+
+    bool operator!=(const str_ref &other) const { return !(*this == other); }
+
+private:
+    const char* _ptr;
+    std::size_t _len;
+    std::string _owned;     // only used for strings with escapes
+};
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_STR_REF_HPP
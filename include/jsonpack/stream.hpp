@@ -0,0 +1,169 @@
+/**
+ *  Jsonpack - Streaming decoder for NDJSON and concatenated documents
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_STREAM_HPP
+#define JSONPACK_STREAM_HPP
+
+#include <cstdio>
+#include <functional>
+
+#include "jsonpack/parser.hpp"
+#include "jsonpack/util/skip.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+// defined in jsonpack.hpp
+template<typename Seq>
+inline void json_unpack_sequence(const char* json, const std::size_t &len, Seq& seq, parser &p);
+
+/**
+ * Read up to len bytes into buf, return the number of bytes read or 0 at the
+ * end of the stream
+ */
+typedef std::function<std::size_t (char* buf, std::size_t len)> read_callback;
+
+/**
+ * Incremental reader of a sequence of JSON documents (objects or arrays)
+ * separated by optional whitespace, like newline-delimited JSON logs.
+ * Input is read in chunks and document boundaries are found while reading,
+ * by the bracket skip of jsonpack/util/skip.hpp resumed on each new chunk,
+ * so memory stays bounded by the largest single document. A document
+ * growing past max_document_size is dropped up to the end of its first line.
+ *
+ * Usage:
+ *   jsonpack::stream_reader reader(stdin);
+ *   MyRecord rec;
+ *   while( reader.next(rec) ) { ... }
+ */
+class stream_reader
+{
+public:
+    static const std::size_t default_max_document = 64 << 20;
+
+    /**
+     * Read from a POSIX file descriptor, it is not closed by the reader
+     */
+    explicit stream_reader(int fd, std::size_t chunk_size = 65536,
+                           std::size_t max_document_size = default_max_document);
+
+    /**
+     * Read from a stdio stream, it is not closed by the reader
+     */
+    explicit stream_reader(FILE* file, std::size_t chunk_size = 65536,
+                           std::size_t max_document_size = default_max_document);
+
+    /**
+     * Read from a user callback
+     */
+    explicit stream_reader(const read_callback &read, std::size_t chunk_size = 65536,
+                           std::size_t max_document_size = default_max_document);
+
+    ~stream_reader();
+
+    /**
+     * Find the next complete document. On success json points to its first
+     * char, the text stays valid until the next call. Return false at the end
+     * of the stream, throw invalid_json on a truncated or malformed stream.
+     * A line that does not start with a document, or the first line of a
+     * document with mismatched brackets or larger than max_document_size, is
+     * dropped before throwing, so reading can go on with the next one.
+     */
+    bool next_document(const char* &json, std::size_t &len);
+
+    /**
+     * Decode the next document into a DEFINE_JSON_ATTRIBUTES object. Escapes
+     * are decoded in place in the reader buffer, str_ref and std::string_view
+     * members stay valid until the next call.
+     */
+    template<typename T>
+    bool next(T &obj)
+    {
+        const char* json;
+        std::size_t len;
+
+        if( !next_document(json, len) )
+            return false;
+
+        obj.json_unpack(json, len, _parser);
+        return true;
+    }
+
+    /**
+     * Decode the next document, a JSON array, into a standard sequence
+     */
+    template<typename Seq>
+    bool next_sequence(Seq &seq)
+    {
+        const char* json;
+        std::size_t len;
+
+        if( !next_document(json, len) )
+            return false;
+
+        json_unpack_sequence(json, len, seq, _parser);
+        return true;
+    }
+
+    /**
+     * Number of documents read so far
+     */
+    std::size_t count() const
+    {
+        return _count;
+    }
+
+private:
+    /**
+     * Read more data at the end of the buffer, return false at end of stream
+     */
+    bool fill();
+
+    /**
+     * Drop the input up to the end of the current line
+     */
+    void skip_line();
+
+#ifndef _MSC_VER
+    //Avoiding implicit default constructor
+    stream_reader(const stream_reader&) = delete ;
+    stream_reader& operator=(const stream_reader&) = delete ;
+#else
+    stream_reader(const stream_reader&) ;
+    stream_reader& operator=(const stream_reader&) ;
+#endif
+
+private:
+    read_callback _read;
+    parser _parser;
+
+    char* _data;
+    std::size_t _alloc;
+    std::size_t _size;      // bytes read into _data
+    std::size_t _begin;     // start of the current document
+    std::size_t _scan;      // bytes of the current document already scanned, 0 if not started
+    std::size_t _chunk;
+    std::size_t _max_document;
+
+    util::skip_state _skip; // boundary scanner state, preserved between reads
+
+    std::size_t _count;
+};
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_STREAM_HPP
@@ -0,0 +1,394 @@
+/**
+ *  Jsonpack - Flat tape representation of parsed documents
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_TAPE_HPP
+#define JSONPACK_TAPE_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+
+#include "jsonpack.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+class tape_ref;
+
+/**
+ * A parsed document as one contiguous array of tagged 64-bit words, filled
+ * by parser::json_validate(json, len, tape). The high byte of a word is the
+ * jsonpack_token_type of the entry, the low 56 bits its payload:
+ *
+ *   '{' / '['          index of the word past the matching close (skip link),
+ *                      followed by a word with the number of members/elements
+ *   '}' / ']'          index of the opening word
+ *   string literal     offset of the content in the json text, followed by a
+ *                      word with its length (bit 63 set if it has escapes)
+ *   integer / real     offset of the number, followed by a word with its length
+ *   true/false/null    offset of the literal
+ *
+ * The members of an object are stored as a string entry (the key) followed
+ * by the value. Words hold offsets and not pointers, so a tape can be copied
+ * or moved around freely; it is released at once and reused by clear().
+ * The json text must outlive the tape.
+ */
+class tape
+{
+public:
+    tape():
+        _words(),
+        _json(nullptr),
+        _insitu(false),
+        _arena()
+    {}
+
+    tape(const tape &t):
+        _words(t._words),
+        _json(t._json),
+        _insitu(t._insitu),
+        _arena()
+    {}
+
+    tape& operator=(const tape &t)
+    {
+        _words = t._words;
+        _json = t._json;
+        _insitu = t._insitu;
+        return *this;
+    }
+
+    static const unsigned tag_shift = 56;
+    static const uint64_t payload_mask = (1ULL << tag_shift) - 1;
+    static const uint64_t escaped_bit = 1ULL << 63;
+
+    static jsonpack_token_type tag(uint64_t word)
+    {
+        return static_cast<jsonpack_token_type>(word >> tag_shift);
+    }
+
+    static std::size_t payload(uint64_t word)
+    {
+        return static_cast<std::size_t>(word & payload_mask);
+    }
+
+    /**
+     * Drop the entries, the memory is kept for the next document
+     */
+    void clear()
+    {
+        _words.clear();
+        _arena.reset();
+    }
+
+    const uint64_t* data() const
+    {
+        return _words.data();
+    }
+
+    /**
+     * Number of words
+     */
+    std::size_t size() const
+    {
+        return _words.size();
+    }
+
+    const char* json() const
+    {
+        return _json;
+    }
+
+    /**
+     * Index of the entry that follows the value at i
+     */
+    std::size_t next(std::size_t i) const
+    {
+        switch( tag(_words[i]) )
+        {
+        case JTK_OPEN_KEY:
+        case JTK_OPEN_BRACKET:
+            return payload(_words[i]);
+        case JTK_STRING_LITERAL:
+        case JTK_INTEGER:
+        case JTK_REAL:
+            return i + 2;
+        default:
+            return i + 1;
+        }
+    }
+
+    /**
+     * The document value, empty if the tape is empty
+     */
+    tape_ref root();
+
+    /**
+     * Fill v with the value at i, objects and arrays are built in the tape
+     * arena and stay valid until the next clear()
+     */
+    void to_value(std::size_t i, jsonpack::value &v);
+
+    /**
+     * Write the value at i as compact JSON into any sink (see jsonpack/sink.hpp).
+     * Strings and numbers are copied from the json text, or referenced in it
+     * by the sinks able to (iovec_sink), the text must then outlive the output.
+     */
+    template<typename Sink>
+    void append(Sink &json, std::size_t i) const;
+
+private:
+    friend struct parser;
+    friend class tape_ref;
+
+    void start(const char* json, bool insitu)
+    {
+        clear();
+        _json = json;
+        _insitu = insitu;
+    }
+
+    void push_scalar(jsonpack_token_type tk, const position &p)
+    {
+        _words.push_back( (static_cast<uint64_t>(tk) << tag_shift) | p._pos );
+
+        if(tk == JTK_STRING_LITERAL)
+            _words.push_back( p._count | (p._escaped ? escaped_bit : 0) );
+        else if(tk == JTK_INTEGER || tk == JTK_REAL)
+            _words.push_back( p._count );
+    }
+
+    std::size_t open_container(jsonpack_token_type tk)
+    {
+        _words.push_back( static_cast<uint64_t>(tk) << tag_shift );
+        _words.push_back( 0 );
+        return _words.size() - 2;
+    }
+
+    void close_container(std::size_t open, jsonpack_token_type tk, std::size_t count)
+    {
+        _words.push_back( (static_cast<uint64_t>(tk) << tag_shift) | open );
+        _words[open] |= _words.size();
+        _words[open + 1] = count;
+    }
+
+    std::vector<uint64_t> _words;
+    const char* _json;
+    bool _insitu;       // string contents are decoded in the json text
+
+    arena _arena;       // containers built by to_value
+};
+
+/**
+ * Handle to a value of a tape, a missing key or index gives an empty handle
+ */
+class tape_ref
+{
+public:
+    tape_ref():
+        _tape(nullptr),
+        _i(0)
+    {}
+
+    tape_ref(tape* t, std::size_t i):
+        _tape(t),
+        _i(i)
+    {}
+
+    tape_ref(const tape_ref &r):
+        _tape(r._tape),
+        _i(r._i)
+    {}
+
+    tape_ref& operator=(const tape_ref &r)
+    {
+        _tape = r._tape;
+        _i = r._i;
+        return *this;
+    }
+
+    bool exists() const
+    {
+        return _tape != nullptr;
+    }
+
+    explicit operator bool() const
+    {
+        return exists();
+    }
+
+    /**
+     * Index of the value in the tape
+     */
+    std::size_t index() const
+    {
+        return _i;
+    }
+
+    /**
+     * Token of the value: JTK_OPEN_KEY for objects, JTK_OPEN_BRACKET for
+     * arrays, the literal type otherwise and JTK_INVALID if empty
+     */
+    jsonpack_token_type type() const
+    {
+        return _tape != nullptr ? tape::tag(_tape->_words[_i]) : JTK_INVALID;
+    }
+
+    /**
+     * Number of members/elements of an object/array, 0 otherwise
+     */
+    std::size_t size() const
+    {
+        jsonpack_token_type t = type();
+        return (t == JTK_OPEN_KEY || t == JTK_OPEN_BRACKET) ? static_cast<std::size_t>(_tape->_words[_i + 1]) : 0;
+    }
+
+    tape_ref operator[](const char* key) const
+    {
+        return find(key, strlen(key));
+    }
+
+    tape_ref operator[](const std::string &key) const
+    {
+        return find(key.data(), key.size());
+    }
+
+    tape_ref operator[](int index) const
+    {
+        return index < 0 ? tape_ref() : at( static_cast<std::size_t>(index) );
+    }
+
+    tape_ref operator[](std::size_t index) const
+    {
+        return at(index);
+    }
+
+    tape_ref find(const char* key, std::size_t len) const;
+
+    tape_ref at(std::size_t index) const;
+
+    /**
+     * Extract the value with the json_traits of T. Throw type_error if the
+     * value is missing or its type does not match T.
+     */
+    template<typename T>
+    void get(T &out) const
+    {
+        if(_tape == nullptr)
+            throw type_error("Missing value");
+
+        jsonpack::value v;
+        _tape->to_value(_i, v);
+
+        if( !type::json_traits<T&>::match_token_type(v) )
+            throw type_error("Invalid value type");
+
+        type::json_traits<T&>::extract(v, const_cast<char*>(_tape->_json), out);
+    }
+
+    template<typename T>
+    T get() const
+    {
+        T out = T();
+        get(out);
+        return out;
+    }
+
+    /**
+     * Write the value as compact JSON, see tape::append
+     */
+    template<typename Sink>
+    void append(Sink &json) const
+    {
+        if(_tape != nullptr)
+            _tape->append(json, _i);
+    }
+
+private:
+    tape* _tape;
+    std::size_t _i;
+};
+
+inline tape_ref tape::root()
+{
+    return _words.empty() ? tape_ref() : tape_ref(this, 0);
+}
+
+template<typename Sink>
+void tape::append(Sink &json, std::size_t i) const
+{
+    uint64_t word = _words[i];
+    jsonpack_token_type tk = tag(word);
+
+    switch(tk)
+    {
+    case JTK_OPEN_KEY:
+    case JTK_OPEN_BRACKET:
+    {
+        bool object = (tk == JTK_OPEN_KEY);
+        json.append(object ? "{" : "[", 1);
+
+        for(std::size_t e = i + 2; e + 1 < payload(word); e = next(e))
+        {
+            if(e != i + 2)
+                json.append(",", 1);
+
+            if(object)
+            {
+                append(json, e);
+                json.append(":", 1);
+                e = next(e);
+            }
+            append(json, e);
+        }
+
+        json.append(object ? "}" : "]", 1);
+        break;
+    }
+    case JTK_STRING_LITERAL:
+    {
+        const char* str = _json + payload(word);
+        std::size_t len = static_cast<std::size_t>(_words[i + 1] & ~escaped_bit);
+
+        json.append("\"", 1);
+        if(_insitu)     // the content was decoded in place
+            util::json_builder::append_escaped(json, str, len);
+        else
+            sink_traits<Sink>::append_stable(json, str, len);
+        json.append("\"", 1);
+        break;
+    }
+    case JTK_INTEGER:
+    case JTK_REAL:
+        sink_traits<Sink>::append_stable(json, _json + payload(word), static_cast<std::size_t>(_words[i + 1]));
+        break;
+    case JTK_TRUE:
+        json.append("true", 4);
+        break;
+    case JTK_FALSE:
+        json.append("false", 5);
+        break;
+    default:
+        json.append("null", 4);
+        break;
+    }
+}
+
+JSONPACK_API_END_NAMESPACE
+
+#endif // JSONPACK_TAPE_HPP
@@ -21,6 +21,8 @@
 
 
 #include "jsonpack/type/json_traits_base.hpp"
+#include "jsonpack/util/numbers.hpp"
+#include "jsonpack/util/unescape.hpp"
 
 
 JSONPACK_API_BEGIN_NAMESPACE
@@ -33,16 +35,28 @@ TYPE_BEGIN_NAMESPACE
 template<>
 struct json_traits<bool>
 {
-    static void append(buffer &json, const char *key, const bool &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const bool &value)
     {
         util::json_builder::append_string(json, key, value ? "true" : "false");
     }
 
-    static void append(buffer &json, const bool &value) //append value in array
+    template<typename Sink>
+    static void append(Sink &json, const bool &value) //append value in array
     {
         json.append(value ? "true," : "false,", value ? 5 :6 );
     }
 
+    static std::size_t size(const char *key, const bool &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const bool &value)
+    {
+        return value ? 5 : 6;
+    }
+
 };
 
 template<>
@@ -65,7 +79,7 @@ struct json_traits<bool&>
             else
             {
                 std::string msg = "Invalid boolean value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -94,20 +108,25 @@ template<>
 struct json_traits<char>
 {
 
-    static void append(buffer &json, const char *key, const char &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const char &value)
     {
-        if( std::isgraph(value) )
-        {
-            char c[4] = {'"', value, '"', '\0'};
-            util::json_builder::append_string(json, key, c);
-        }
-        else
-            util::json_builder::append_string(json, key, "null");
+        json.append("\"" , 1);
+        json.append( key, strlen(key) ); //"key"
+        json.append("\":", 2);
+
+        append(json, value);
     }
 
-    static void append(buffer &json, const char &value)
+    template<typename Sink>
+    static void append(Sink &json, const char &value)
     {
-        if( std::isgraph(value) )
+        if( value == '"' || value == '\\' )
+        {
+            char c[5] = {'"', '\\', value, '"', ','};
+            json.append(c, 5);
+        }
+        else if( std::isgraph(value) )
         {
             char c[4] = {'"', value, '"', ','};
             json.append(c, 4);
@@ -115,6 +134,18 @@ struct json_traits<char>
         else
             json.append("null,", 5);
     }
+
+    static std::size_t size(const char *key, const char &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const char &value)
+    {
+        if( value == '"' || value == '\\' )
+            return 5;
+        return std::isgraph(value) ? 4 : 5;
+    }
 };
 
 template<>
@@ -137,7 +168,7 @@ struct json_traits<char&>
             else
             {
                 std::string msg = "Invalid char value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -145,7 +176,24 @@ struct json_traits<char&>
 
     static void extract(const jsonpack::value &v, char* json_ptr, char &value)
     {
-        value = v._pos._type != JTK_NULL ? json_ptr[v._pos._pos] : 0;
+        position p = v._pos;
+
+        if(p._type == JTK_NULL)
+        {
+            value = 0;
+        }
+        else if(p._escaped && json_ptr[p._pos] == '\\')
+        {
+            const char* src = json_ptr + p._pos;
+            char decoded[4];
+            if( util::unescape_one(src, json_ptr + p._pos + p._count, decoded) == 0 )
+                throw invalid_json("Invalid escape sequence in string");
+            value = decoded[0];
+        }
+        else
+        {
+            value = json_ptr[p._pos];
+        }
     }
 
     static bool match_token_type(const jsonpack::value &v)
@@ -162,15 +210,27 @@ template<>
 struct json_traits<int>
 {
 
-    static void append(buffer &json, const char *key, const int &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const int &value)
     {
         util::json_builder::append_integer(json, key, value);
     }
 
-    static void append(buffer &json, const int &value)
+    template<typename Sink>
+    static void append(Sink &json, const int &value)
     {
         util::json_builder::append_integer(json, value);
     }
+
+    static std::size_t size(const char *key, const int &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const int &value)
+    {
+        return util::json_builder::integer_size( static_cast<long long>(value) ) + 1;
+    }
 };
 
 template<>
@@ -193,7 +253,7 @@ struct json_traits<int&>
             else
             {
                 std::string msg = "Invalid int value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
 
@@ -202,25 +262,10 @@ struct json_traits<int&>
 
     static void extract(const jsonpack::value &v, char* json_ptr, int &value)
     {
-
         position p = v._pos;
 
-        if( p._count > INT_MAX_DIGITS + 1)
-            throw type_error("Int out of range");
-
-        char * str_value = json_ptr+p._pos;   //pointing to the start
-        char buffer[LONG_MAX_DIGITS + 1];
-        memcpy(buffer, str_value, p._count);
-        buffer[p._count] = '\0';        //null-terminated
-
-        long v_cpy = std::strtol(buffer, nullptr, 10);
-
-        if(errno ||
-                     v_cpy > std::numeric_limits<int>::max() ||
-                     v_cpy < std::numeric_limits<int>::min() )
+        if( !util::parse_integer(json_ptr + p._pos, p._count, value) )
             throw type_error("Int out of range");
-        value = v_cpy;
-
     }
 
     static bool match_token_type(const jsonpack::value &v)
@@ -237,15 +282,27 @@ struct json_traits<int&>
 template<>
 struct json_traits<unsigned int>
 {
-    static void append(buffer &json, const char *key, const unsigned int &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const unsigned int &value)
     {
         util::json_builder::append_integer(json, key, value);
     }
 
-    static void append(buffer &json, const unsigned int &value)
+    template<typename Sink>
+    static void append(Sink &json, const unsigned int &value)
     {
         util::json_builder::append_integer(json, value);
     }
+
+    static std::size_t size(const char *key, const unsigned int &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const unsigned int &value)
+    {
+        return util::json_builder::integer_size( static_cast<unsigned long long>(value) ) + 1;
+    }
 };
 
 template<>
@@ -267,7 +324,7 @@ struct json_traits<unsigned int&>
             else
             {
                 std::string msg = "Invalid unsigned int value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -277,24 +334,8 @@ struct json_traits<unsigned int&>
     {
         position p = v._pos;
 
-        if( p._count > LONG_MAX_DIGITS + 1)
-            throw type_error("Unsigned int out of range");
-
-        //TODO check for sign
-        char * str_value = json_ptr+p._pos;   //pointing to the start
-        char buffer[LONG_MAX_DIGITS + 1];
-        memcpy(buffer, str_value, p._count);
-        buffer[p._count] = '\0';            //null-terminated
-
-        unsigned long v_cpy = std::strtoul(buffer, nullptr, 10);
-
-        if(errno ||
-                     v_cpy > std::numeric_limits<unsigned int>::max() ||
-                     v_cpy < std::numeric_limits<unsigned int>::min() ) // check range
+        if( !util::parse_integer(json_ptr + p._pos, p._count, value) )
             throw type_error("Unsigned int out of range");
-        value = v_cpy;
-
-//        value = atoi( buffer );              //converting value
     }
 
     static bool match_token_type(const jsonpack::value &v)
@@ -311,15 +352,27 @@ struct json_traits<unsigned int&>
 template<>
 struct json_traits<long>
 {
-    static void append(buffer &json, const char *key, const long &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const long &value)
     {
         util::json_builder::append_integer(json, key, value);
     }
 
-    static void append(buffer &json, const long &value)
+    template<typename Sink>
+    static void append(Sink &json, const long &value)
     {
         util::json_builder::append_integer(json, value);
     }
+
+    static std::size_t size(const char *key, const long &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const long &value)
+    {
+        return util::json_builder::integer_size( static_cast<long long>(value) ) + 1;
+    }
 };
 
 template<>
@@ -341,7 +394,7 @@ struct json_traits<long&>
             else
             {
                 std::string msg = "Invalid long int value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -351,17 +404,7 @@ struct json_traits<long&>
     {
         position p = v._pos;
 
-        if( p._count > LONG_MAX_DIGITS + 1)
-            throw type_error("Long out of range");
-
-        char * str_value = json_ptr+p._pos;   //pointing to the start
-        char buffer[LONG_MAX_DIGITS + 1];
-        memcpy(buffer, str_value, p._count);
-        buffer[p._count] = '\0';        //null-terminated
-
-        value = std::strtol(buffer, nullptr, 10);
-
-        if(errno) // check range
+        if( !util::parse_integer(json_ptr + p._pos, p._count, value) )
             throw type_error("Long out of range");
     }
 
@@ -383,16 +426,28 @@ template<>
 struct json_traits<unsigned long>
 {
 
-    static void append(buffer &json, const char *key, const unsigned long &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const unsigned long &value)
     {
         util::json_builder::append_integer(json, key, value);
     }
 
-    static void append(buffer &json, const unsigned long &value)
+    template<typename Sink>
+    static void append(Sink &json, const unsigned long &value)
     {
         util::json_builder::append_integer(json, value);
     }
 
+    static std::size_t size(const char *key, const unsigned long &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const unsigned long &value)
+    {
+        return util::json_builder::integer_size( static_cast<unsigned long long>(value) ) + 1;
+    }
+
 };
 
 template<>
@@ -414,7 +469,7 @@ struct json_traits<unsigned long&>
             else
             {
                 std::string msg = "Invalid unsigned long int value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -424,21 +479,79 @@ struct json_traits<unsigned long&>
     {
         position p = v._pos;
 
-        if( p._count > LONG_MAX_DIGITS + 1)
+        if( !util::parse_integer(json_ptr + p._pos, p._count, value) )
             throw type_error("Unsigned long out of range");
+    }
 
-        //TODO check for sign
-        char * str_value = json_ptr+p._pos;   //pointing to the start
-        char buffer[LONG_MAX_DIGITS + 1];
-        memcpy(buffer, str_value, p._count);
-        buffer[p._count] = '\0';        //null-terminated
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return (v._field == _POS &&
+                (v._pos._type == JTK_INTEGER || v._pos._type == JTK_REAL ));
+    }
+};
 
-        value = std::strtoul(buffer, nullptr, 10);
 
-        if(errno) // check range
-            throw type_error("Unsigned long out of range");
+//------------------------- LONG LONG ----------------------------
+/**
+ *  long long type traits specialization
+ */
+template<>
+struct json_traits<long long>
+{
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const long long &value)
+    {
+        util::json_builder::append_integer(json, key, value);
+    }
+
+    template<typename Sink>
+    static void append(Sink &json, const long long &value)
+    {
+        util::json_builder::append_integer(json, value);
+    }
+
+    static std::size_t size(const char *key, const long long &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
 
-//        value = atol( buffer );
+    static std::size_t size(const long long &value)
+    {
+        return util::json_builder::integer_size( static_cast<long long>(value) ) + 1;
+    }
+};
+
+template<>
+struct json_traits<long long&>
+{
+    static void extract(const object_t &json, char* json_ptr, const char *key, const std::size_t &len, long long &value)
+    {
+        jsonpack::key k;
+        k._bytes = len;
+        k._ptr = key;
+
+        object_t::const_iterator found = json.find(k);
+        if( found != json.end() )    // exist the current key
+        {
+            if( match_token_type(found->second) )
+            {
+                extract(found->second, json_ptr, value);
+            }
+            else
+            {
+                std::string msg = "Invalid long long int value for key: ";
+                msg.append(key, len);
+                throw type_error( msg.data() );
+            }
+        }
+    }
+
+    static void extract(const jsonpack::value &v, char* json_ptr, long long &value)
+    {
+        position p = v._pos;
+
+        if( !util::parse_integer(json_ptr + p._pos, p._count, value) )
+            throw type_error("Long long out of range");
     }
 
     static bool match_token_type(const jsonpack::value &v)
@@ -446,8 +559,82 @@ struct json_traits<unsigned long&>
         return (v._field == _POS &&
                 (v._pos._type == JTK_INTEGER || v._pos._type == JTK_REAL ));
     }
+
+};
+
+//**************************************************************
+//******************* UNSIGNED LONG LONG ***********************
+//**************************************************************
+/**
+ *  unsigned long long type traits specialization
+ */
+template<>
+struct json_traits<unsigned long long>
+{
+
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const unsigned long long &value)
+    {
+        util::json_builder::append_integer(json, key, value);
+    }
+
+    template<typename Sink>
+    static void append(Sink &json, const unsigned long long &value)
+    {
+        util::json_builder::append_integer(json, value);
+    }
+
+    static std::size_t size(const char *key, const unsigned long long &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const unsigned long long &value)
+    {
+        return util::json_builder::integer_size( static_cast<unsigned long long>(value) ) + 1;
+    }
+
 };
 
+template<>
+struct json_traits<unsigned long long&>
+{
+    static void extract(const object_t &json, char* json_ptr, const char *key, const std::size_t &len, unsigned long long &value)
+    {
+        jsonpack::key k;
+        k._bytes = len;
+        k._ptr = key;
+
+        object_t::const_iterator found = json.find(k);
+        if( found != json.end() )    // exist the current key
+        {
+            if( match_token_type(found->second) )
+            {
+                extract(found->second, json_ptr, value);
+            }
+            else
+            {
+                std::string msg = "Invalid unsigned long long int value for key: ";
+                msg.append(key, len);
+                throw type_error( msg.data() );
+            }
+        }
+    }
+
+    static void extract(const jsonpack::value &v, char* json_ptr, unsigned long long &value)
+    {
+        position p = v._pos;
+
+        if( !util::parse_integer(json_ptr + p._pos, p._count, value) )
+            throw type_error("Unsigned long long out of range");
+    }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return (v._field == _POS &&
+                (v._pos._type == JTK_INTEGER || v._pos._type == JTK_REAL ));
+    }
+};
 
 JSONPACK_API_END_NAMESPACE //type
 JSONPACK_API_END_NAMESPACE //jsonpack
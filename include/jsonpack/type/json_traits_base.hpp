@@ -35,20 +35,35 @@ struct json_traits
     /**
      * Add the object in json buffer like "key": {value},
      */
-    static void append(buffer &json, const char *key, const T &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const T &value)
     {
-        util::json_builder::append_string(json, key, const_cast<T&>(value).json_pack() );
+        json.append("\"", 1);
+        json.append(key, strlen(key));
+        json.append("\":", 2);
+        value.json_append(json);    // in place, no intermediate string
+        json.append(",", 1);
     }
 
     /**
      * Add the object in json buffer like {value},
      */
-    static void append(buffer &json, const T &value)
+    template<typename Sink>
+    static void append(Sink &json, const T &value)
     {
-        char* str = const_cast<T&>(value).json_pack();
-        json.append(str, strlen(str));
+        value.json_append(json);
         json.append(",", 1);
     }
+
+    static std::size_t size(const char *key, const T &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const T &value)
+    {
+        return value.json_size() + 1;
+    }
 };
 
 template<typename T>
@@ -83,7 +98,7 @@ struct json_traits<T&>
             else
             {
                 std::string msg = "Invalid object value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
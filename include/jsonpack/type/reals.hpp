@@ -20,6 +20,7 @@
 #define JSONPACK_REALS_HPP
 
 #include "jsonpack/type/json_traits_base.hpp"
+#include "jsonpack/util/numbers.hpp"
 
 
 JSONPACK_API_BEGIN_NAMESPACE
@@ -30,15 +31,27 @@ template<>
 struct json_traits<float>
 {
 
-    static void append(buffer &json, const char *key, const float &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const float &value)
     {
         util::json_builder::append_real(json, key, value);
     }
 
-    static void append(buffer &json, const float &value)
+    template<typename Sink>
+    static void append(Sink &json, const float &value)
     {
         util::json_builder::append_real(json, value);
     }
+
+    static std::size_t size(const char *key, const float &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const float &value)
+    {
+        return util::json_builder::real_size(value) + 1;
+    }
 };
 
 template<>
@@ -60,7 +73,7 @@ struct json_traits<float&>
             else
             {
                 std::string msg = "Invalid float value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -70,24 +83,8 @@ struct json_traits<float&>
     {
         position p = v._pos;
 
-        char * str_value = json_ptr + p._pos;   //pointing to the start
-        char buffer[DOUBLE_MAX_DIGITS + 1];
-        const unsigned long len = p._count < DOUBLE_MAX_DIGITS + 1 ? p._count : DOUBLE_MAX_DIGITS ;
-        memcpy(buffer, str_value, len);
-        buffer[len] = '\0';    //null-terminated
-
-#ifndef _MSC_VER
-        value = std::strtof(buffer, nullptr);
-        if(errno) // check range
-            throw type_error("Float out of range");
-#else
-        double v_cpy = std::strtod(buffer, nullptr);
-        if(errno ||
-                v_cpy > std::numeric_limits<float>::max() ||
-                v_cpy < std::numeric_limits<float>::min() )
+        if( !util::parse_real(json_ptr + p._pos, p._count, value) )
             throw type_error("Float out of range");
-		value = static_cast<float>(v_cpy);
-#endif
     }
 
     static bool match_token_type(const jsonpack::value &v)
@@ -102,15 +99,27 @@ struct json_traits<float&>
 template<>
 struct json_traits<double>
 {
-    static void append(buffer &json, const char *key, const double &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const double &value)
     {
         util::json_builder::append_real(json, key, value);
     }
 
-    static void append(buffer &json, const double &value)
+    template<typename Sink>
+    static void append(Sink &json, const double &value)
     {
         util::json_builder::append_real(json, value);
     }
+
+    static std::size_t size(const char *key, const double &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const double &value)
+    {
+        return util::json_builder::real_size(value) + 1;
+    }
 };
 
 template<>
@@ -132,7 +141,7 @@ struct json_traits<double&>
             else
             {
                 std::string msg = "Invalid double value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -141,15 +150,8 @@ struct json_traits<double&>
     static void extract(const jsonpack::value &v, char* json_ptr, double &value)
     {
         position p = v._pos;
-        char * str_value = json_ptr + p._pos; //pointing to the start
-        char buffer[DOUBLE_MAX_DIGITS + 1];
-        const unsigned long len = p._count < DOUBLE_MAX_DIGITS + 1 ? p._count : DOUBLE_MAX_DIGITS ;
-        memcpy(buffer, str_value, len);
-        buffer[len] = '\0';     //null-terminated
-
-        value = std::strtod(buffer, nullptr);
 
-        if(errno) // check range
+        if( !util::parse_real(json_ptr + p._pos, p._count, value) )
             throw type_error("Double out of range");
     }
 
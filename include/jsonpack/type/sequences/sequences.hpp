@@ -42,7 +42,8 @@ struct sequence_traits
 {
     typedef typename Seq::value_type type_t;
 
-    static void append(buffer &json, const char *key, const Seq &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const Seq &value)
     {
         json.append("\"", 1);
         json.append(key, strlen(key) );
@@ -57,7 +58,8 @@ struct sequence_traits
         json.append("],", 2);
     }
 
-    static void append(buffer &json, const Seq &value)
+    template<typename Sink>
+    static void append(Sink &json, const Seq &value)
     {
         json.append("[", 1);
 
@@ -69,6 +71,23 @@ struct sequence_traits
         json.append("],", 2);
     }
 
+    static std::size_t size(const char *key, const Seq &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const Seq &value)
+    {
+        std::size_t size = 3;   // [],
+
+        for(const auto &v : value)
+        {
+            size += json_traits<type_t>::size(v);
+        }
+
+        return value.begin() != value.end() ? size - 1 : size; // last comma erased
+    }
+
 };
 
 template<typename Seq>
@@ -92,7 +111,7 @@ struct sequence_traits<Seq&>
             else
             {
                 std::string msg = "Invalid array value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -100,7 +119,7 @@ struct sequence_traits<Seq&>
 
     static void extract(const jsonpack::value &v, char* json_ptr, Seq &value)
     {
-        array_t arr = *v._arr;
+        const array_t &arr = *v._arr;
         value.clear();
 
         for(const auto &it : arr)
@@ -123,6 +142,11 @@ struct sequence_traits<Seq&>
         }
 
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return v._field == _ARR;
+    }
 };
 
 /** **********************************************************************
@@ -131,15 +155,27 @@ struct sequence_traits<Seq&>
 template<typename T, std::size_t N >
 struct json_traits< std::array<T,N> >
 {
-    static void append(buffer &json, const char *key, const std::array<T,N> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::array<T,N> &value)
     {
         sequence_traits< std::array<T,N> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::array<T,N> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::array<T,N> &value)
     {
         sequence_traits< std::array<T,N> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::array<T,N> &value)
+    {
+        return sequence_traits< std::array<T,N> >::size(key, value);
+    }
+
+    static std::size_t size(const std::array<T,N> &value)
+    {
+        return sequence_traits< std::array<T,N> >::size(value);
+    }
 };
 
 template<typename T, std::size_t N >
@@ -161,7 +197,7 @@ struct json_traits<std::array<T,N>& >
             else
             {
                 std::string msg = "Invalid array value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -170,7 +206,7 @@ struct json_traits<std::array<T,N>& >
     
     static void extract(const jsonpack::value &v, char* json_ptr, std::array<T,N> &value)
     {
-        array_t arr = *v._arr;
+        const array_t &arr = *v._arr;
 
         for(std::size_t i = 0 ; i < arr.size(); ++i)
         {
@@ -194,6 +230,10 @@ struct json_traits<std::array<T,N>& >
         }
     }
 
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return v._field == _ARR;
+    }
 };
 
 
@@ -203,16 +243,28 @@ struct json_traits<std::array<T,N>& >
 template<typename T>
 struct json_traits< std::vector<T> >
 {
-    static void append(buffer &json, const char *key, const std::vector<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::vector<T> &value)
     {
         sequence_traits< std::vector<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::vector<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::vector<T> &value)
     {
         sequence_traits< std::vector<T> >::append(json, value);
     }
 
+    static std::size_t size(const char *key, const std::vector<T> &value)
+    {
+        return sequence_traits< std::vector<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::vector<T> &value)
+    {
+        return sequence_traits< std::vector<T> >::size(value);
+    }
+
 };
 
 template<typename T>
@@ -227,6 +279,11 @@ struct json_traits<std::vector<T>& >
     {
         sequence_traits< std::vector<T>& >::extract(v, json_ptr, value);
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return sequence_traits< std::vector<T>& >::match_token_type(v);
+    }
 };
 
 /** **********************************************************************
@@ -235,15 +292,27 @@ struct json_traits<std::vector<T>& >
 template<typename T>
 struct json_traits< std::deque<T> >
 {
-    static void append(buffer &json, const char *key, const std::deque<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::deque<T> &value)
     {
         sequence_traits< std::deque<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::deque<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::deque<T> &value)
     {
         sequence_traits< std::deque<T> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::deque<T> &value)
+    {
+        return sequence_traits< std::deque<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::deque<T> &value)
+    {
+        return sequence_traits< std::deque<T> >::size(value);
+    }
 };
 
 template<typename T>
@@ -258,6 +327,11 @@ struct json_traits<std::deque<T>& >
     {
         sequence_traits< std::deque<T>& >::extract(v, json_ptr, value);
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return sequence_traits< std::deque<T>& >::match_token_type(v);
+    }
 };
 
 /** **********************************************************************
@@ -266,15 +340,27 @@ struct json_traits<std::deque<T>& >
 template<typename T>
 struct json_traits< std::list<T> >
 {
-    static void append(buffer &json, const char *key, const std::list<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::list<T> &value)
     {
         sequence_traits< std::list<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::list<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::list<T> &value)
     {
         sequence_traits< std::list<T> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::list<T> &value)
+    {
+        return sequence_traits< std::list<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::list<T> &value)
+    {
+        return sequence_traits< std::list<T> >::size(value);
+    }
 };
 
 template<typename T>
@@ -289,6 +375,11 @@ struct json_traits<std::list<T>& >
     {
         sequence_traits< std::list<T>& >::extract(v, json_ptr, value);
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return sequence_traits< std::list<T>& >::match_token_type(v);
+    }
 };
 
 /** **********************************************************************
@@ -297,15 +388,27 @@ struct json_traits<std::list<T>& >
 template<typename T>
 struct json_traits< std::forward_list<T> >
 {
-    static void append(buffer &json, const char *key, const std::forward_list<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::forward_list<T> &value)
     {
         sequence_traits< std::forward_list<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::forward_list<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::forward_list<T> &value)
     {
         sequence_traits< std::forward_list<T> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::forward_list<T> &value)
+    {
+        return sequence_traits< std::forward_list<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::forward_list<T> &value)
+    {
+        return sequence_traits< std::forward_list<T> >::size(value);
+    }
 };
 
 // get elements in inverse order
@@ -328,7 +431,7 @@ struct json_traits<std::forward_list<T>& >
             else
             {
                 std::string msg = "Invalid array value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -336,7 +439,7 @@ struct json_traits<std::forward_list<T>& >
 
     static void extract(const jsonpack::value &v, char* json_ptr, std::forward_list<T> &value)
     {
-        array_t arr = *v._arr;
+        const array_t &arr = *v._arr;
 
         value.clear();
 
@@ -361,6 +464,11 @@ struct json_traits<std::forward_list<T>& >
 
         }
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return v._field == _ARR;
+    }
 };
 
 /** **********************************************************************
@@ -369,15 +477,27 @@ struct json_traits<std::forward_list<T>& >
 template<typename T>
 struct json_traits< std::set<T> >
 {
-    static void append(buffer &json, const char *key, const std::set<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::set<T> &value)
     {
         sequence_traits< std::set<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::set<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::set<T> &value)
     {
         sequence_traits< std::set<T> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::set<T> &value)
+    {
+        return sequence_traits< std::set<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::set<T> &value)
+    {
+        return sequence_traits< std::set<T> >::size(value);
+    }
 };
 
 template<typename T>
@@ -392,6 +512,11 @@ struct json_traits<std::set<T>& >
     {
         sequence_traits< std::set<T>& >::extract(v, json_ptr, value);
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return sequence_traits< std::set<T>& >::match_token_type(v);
+    }
 };
 
 /** **********************************************************************
@@ -400,15 +525,27 @@ struct json_traits<std::set<T>& >
 template<typename T>
 struct json_traits< std::multiset<T> >
 {
-    static void append(buffer &json, const char *key, const std::multiset<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::multiset<T> &value)
     {
         sequence_traits< std::multiset<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::multiset<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::multiset<T> &value)
     {
         sequence_traits< std::multiset<T> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::multiset<T> &value)
+    {
+        return sequence_traits< std::multiset<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::multiset<T> &value)
+    {
+        return sequence_traits< std::multiset<T> >::size(value);
+    }
 };
 
 template<typename T>
@@ -423,6 +560,11 @@ struct json_traits<std::multiset<T>& >
     {
         sequence_traits< std::multiset<T>& >::extract(v, json_ptr, value);
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return sequence_traits< std::multiset<T>& >::match_token_type(v);
+    }
 };
 
 /** **********************************************************************
@@ -431,15 +573,27 @@ struct json_traits<std::multiset<T>& >
 template<typename T>
 struct json_traits< std::unordered_set<T> >
 {
-    static void append(buffer &json, const char *key, const std::unordered_set<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::unordered_set<T> &value)
     {
         sequence_traits< std::unordered_set<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::unordered_set<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::unordered_set<T> &value)
     {
         sequence_traits< std::unordered_set<T> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::unordered_set<T> &value)
+    {
+        return sequence_traits< std::unordered_set<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::unordered_set<T> &value)
+    {
+        return sequence_traits< std::unordered_set<T> >::size(value);
+    }
 };
 
 template<typename T>
@@ -458,6 +612,11 @@ struct json_traits<std::unordered_set<T>& >
     {
         value.insert(value.rbegin() , data);
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return sequence_traits< std::unordered_set<T>& >::match_token_type(v);
+    }
 };
 
 /** **********************************************************************
@@ -466,15 +625,27 @@ struct json_traits<std::unordered_set<T>& >
 template<typename T>
 struct json_traits< std::unordered_multiset<T> >
 {
-    static void append(buffer &json, const char *key, const std::unordered_multiset<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::unordered_multiset<T> &value)
     {
         sequence_traits< std::unordered_multiset<T> >::append(json, key, value);
     }
 
-    static void append(buffer &json, const std::unordered_multiset<T> &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::unordered_multiset<T> &value)
     {
         sequence_traits< std::unordered_multiset<T> >::append(json, value);
     }
+
+    static std::size_t size(const char *key, const std::unordered_multiset<T> &value)
+    {
+        return sequence_traits< std::unordered_multiset<T> >::size(key, value);
+    }
+
+    static std::size_t size(const std::unordered_multiset<T> &value)
+    {
+        return sequence_traits< std::unordered_multiset<T> >::size(value);
+    }
 };
 
 template<typename T>
@@ -489,6 +660,11 @@ struct json_traits<std::unordered_multiset<T>& >
     {
         sequence_traits< std::unordered_multiset<T>& >::extract(v, json_ptr, value);
     }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return sequence_traits< std::unordered_multiset<T>& >::match_token_type(v);
+    }
 };
 
 
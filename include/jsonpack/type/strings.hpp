@@ -21,7 +21,15 @@
 
 #include <algorithm>
 
+#include "jsonpack/config.hpp"
+
+#ifdef JSONPACK_HAS_STRING_VIEW
+#include <string_view>
+#endif
+
 #include "jsonpack/type/json_traits_base.hpp"
+#include "jsonpack/str_ref.hpp"
+#include "jsonpack/util/unescape.hpp"
 
 JSONPACK_API_BEGIN_NAMESPACE
 TYPE_BEGIN_NAMESPACE
@@ -32,7 +40,8 @@ template<>
 struct json_traits<char*>
 {
 
-    static void append(buffer &json, const char *key, const char* value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const char* value)
     {
         json.append("\"" , 1);
         json.append( key, strlen(key) ); //"key"
@@ -41,12 +50,13 @@ struct json_traits<char*>
         append(json, value);
     }
 
-    static void append(buffer &json, const char* value)
+    template<typename Sink>
+    static void append(Sink &json, const char* value)
     {
         if(value != nullptr)
         {
             json.append("\"", 1);
-            json.append( value, strlen(value)); //value
+            util::json_builder::append_escaped(json, value, strlen(value)); //value
             json.append("\",", 2);
         }
         else
@@ -55,6 +65,16 @@ struct json_traits<char*>
         }
     }
 
+    static std::size_t size(const char *key, const char* value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const char* value)
+    {
+        return value != nullptr ? util::json_builder::escaped_size(value, strlen(value)) + 3 : 5;
+    }
+
 };
 
 template<>
@@ -77,7 +97,7 @@ struct json_traits<char*&>
             else
             {
                 std::string msg = "Invalid string value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -92,8 +112,19 @@ struct json_traits<char*&>
         {
             value = (char*)malloc( p._count + 1) ;
             if(!value) throw alloc_error();
-            memcpy( value, json_ptr + p._pos, p._count);
-            value[p._count] = '\0';
+
+            std::size_t count = p._count;
+            if(!p._escaped)
+            {
+                memcpy( value, json_ptr + p._pos, p._count);
+            }
+            else if( !util::unescape(json_ptr + p._pos, p._count, value, count) )
+            {
+                free(value);
+                value = nullptr;
+                throw invalid_json("Invalid escape sequence in string");
+            }
+            value[count] = '\0';
         }
         else
         {
@@ -116,7 +147,8 @@ template<>
 struct json_traits<std::string>
 {
 
-    static void append(buffer &json, const char *key, const std::string &value)
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::string &value)
     {
         json.append("\"" , 1);
         json.append( key, strlen(key) ); //"key"
@@ -125,12 +157,13 @@ struct json_traits<std::string>
         append(json, value);
     }
 
-    static void append(buffer &json, const std::string &value)
+    template<typename Sink>
+    static void append(Sink &json, const std::string &value)
     {
         if(! value.empty() )    //:"value"
         {
             json.append("\"", 1);
-            json.append( value.c_str(), value.length() );
+            util::json_builder::append_escaped(json, value.data(), value.length());
             json.append("\",", 2);
         }
         else                    //:null
@@ -139,6 +172,16 @@ struct json_traits<std::string>
         }
     }
 
+    static std::size_t size(const char *key, const std::string &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const std::string &value)
+    {
+        return !value.empty() ? util::json_builder::escaped_size(value.data(), value.length()) + 3 : 5;
+    }
+
 };
 
 template<>
@@ -161,7 +204,7 @@ struct json_traits<std::string&>
             else
             {
                 std::string msg = "Invalid std::string value for key: ";
-                msg += key;
+                msg.append(key, len);
                 throw type_error( msg.data() );
             }
         }
@@ -173,7 +216,125 @@ struct json_traits<std::string&>
         if(p._type != JTK_NULL)
         {
             value.resize(p._count);
-            memcpy( const_cast<char*>(value.data()), json_ptr+ p._pos, p._count); // FIX undefined behavior
+            if(!p._escaped)
+            {
+                memcpy( &value[0], json_ptr+ p._pos, p._count);
+            }
+            else
+            {
+                // decoded text is never longer than the source
+                std::size_t count;
+                if( !util::unescape(json_ptr + p._pos, p._count, &value[0], count) )
+                    throw invalid_json("Invalid escape sequence in string");
+                value.resize(count);
+            }
+        }
+    }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return (v._field == _POS &&
+                (v._pos._type == JTK_STRING_LITERAL || v._pos._type == JTK_NULL ) );
+    }
+
+
+};
+
+
+//-------------------------- STR_REF -----------------------------------
+
+template<>
+struct json_traits<str_ref>
+{
+
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const str_ref &value)
+    {
+        json.append("\"" , 1);
+        json.append( key, strlen(key) ); //"key"
+        json.append("\":", 2);
+
+        append(json, value);
+    }
+
+    template<typename Sink>
+    static void append(Sink &json, const str_ref &value)
+    {
+        if(value.data() != nullptr)
+        {
+            json.append("\"", 1);
+            util::json_builder::append_escaped(json, value.data(), value.size()); //value
+            json.append("\",", 2);
+        }
+        else
+        {
+            json.append( "null," , 5 ); //null
+        }
+    }
+
+    static std::size_t size(const char *key, const str_ref &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const str_ref &value)
+    {
+        return value.data() != nullptr ? util::json_builder::escaped_size(value.data(), value.size()) + 3 : 5;
+    }
+
+};
+
+template<>
+struct json_traits<str_ref&>
+{
+
+    static void extract(const object_t &json, char* json_ptr, const char *key, const std::size_t &len, str_ref &value)
+    {
+        jsonpack::key k;
+        k._bytes = len;
+        k._ptr = key;
+
+        object_t::const_iterator found = json.find(k);
+        if( found != json.end() )    // exist the current key
+        {
+            if( match_token_type(found->second) )
+            {
+                extract(found->second, json_ptr, value);
+            }
+            else
+            {
+                std::string msg = "Invalid string value for key: ";
+                msg.append(key, len);
+                throw type_error( msg.data() );
+            }
+        }
+    }
+
+    /**
+     * Reference the string in json_ptr. Escapes are already decoded by an
+     * in-situ parser, otherwise a string with escapes is decoded into an
+     * owned copy
+     */
+    static void extract(const jsonpack::value &v, char* json_ptr, str_ref &value)
+    {
+        position p = v._pos;
+
+        if(p._type == JTK_NULL)
+        {
+            value.assign(nullptr, 0);
+        }
+        else if(!p._escaped)
+        {
+            value.assign(json_ptr + p._pos, p._count);
+        }
+        else
+        {
+            std::string tmp(p._count, '\0');
+            std::size_t count;
+            if( !util::unescape(json_ptr + p._pos, p._count, &tmp[0], count) )
+                throw invalid_json("Invalid escape sequence in string");
+
+            value.assign_copy(tmp.data(), count);
         }
     }
 
@@ -183,9 +344,108 @@ struct json_traits<std::string&>
                 (v._pos._type == JTK_STRING_LITERAL || v._pos._type == JTK_NULL ) );
     }
 
+};
+
+#ifdef JSONPACK_HAS_STRING_VIEW
+//-------------------------- STD::STRING_VIEW -----------------------------------
+
+template<>
+struct json_traits<std::string_view>
+{
+
+    template<typename Sink>
+    static void append(Sink &json, const char *key, const std::string_view &value)
+    {
+        json.append("\"" , 1);
+        json.append( key, strlen(key) ); //"key"
+        json.append("\":", 2);
+
+        append(json, value);
+    }
+
+    template<typename Sink>
+    static void append(Sink &json, const std::string_view &value)
+    {
+        if(value.data() != nullptr)
+        {
+            json.append("\"", 1);
+            util::json_builder::append_escaped(json, value.data(), value.size()); //value
+            json.append("\",", 2);
+        }
+        else
+        {
+            json.append( "null," , 5 ); //null
+        }
+    }
+
+    static std::size_t size(const char *key, const std::string_view &value)
+    {
+        return util::json_builder::key_size(key) + size(value);
+    }
+
+    static std::size_t size(const std::string_view &value)
+    {
+        return value.data() != nullptr ? util::json_builder::escaped_size(value.data(), value.size()) + 3 : 5;
+    }
 
 };
 
+template<>
+struct json_traits<std::string_view&>
+{
+
+    static void extract(const object_t &json, char* json_ptr, const char *key, const std::size_t &len, std::string_view &value)
+    {
+        jsonpack::key k;
+        k._bytes = len;
+        k._ptr = key;
+
+        object_t::const_iterator found = json.find(k);
+        if( found != json.end() )    // exist the current key
+        {
+            if( match_token_type(found->second) )
+            {
+                extract(found->second, json_ptr, value);
+            }
+            else
+            {
+                std::string msg = "Invalid std::string_view value for key: ";
+                msg.append(key, len);
+                throw type_error( msg.data() );
+            }
+        }
+    }
+
+    /**
+     * Reference the string in json_ptr. A view can not own a decoded copy,
+     * so strings with escapes need an in-situ parser (see json_unpack_insitu)
+     */
+    static void extract(const jsonpack::value &v, char* json_ptr, std::string_view &value)
+    {
+        position p = v._pos;
+
+        if(p._type == JTK_NULL)
+        {
+            value = std::string_view();
+        }
+        else if(!p._escaped)
+        {
+            value = std::string_view(json_ptr + p._pos, p._count);
+        }
+        else
+        {
+            throw type_error("String with escapes can not be referenced by std::string_view, use in-situ parsing");
+        }
+    }
+
+    static bool match_token_type(const jsonpack::value &v)
+    {
+        return (v._field == _POS &&
+                (v._pos._type == JTK_STRING_LITERAL || v._pos._type == JTK_NULL ) );
+    }
+
+};
+#endif // JSONPACK_HAS_STRING_VIEW
 
 JSONPACK_API_END_NAMESPACE //type
 JSONPACK_API_END_NAMESPACE //jsonpack
@@ -28,6 +28,8 @@
 
 
 #include "jsonpack/buffer.hpp"
+#include "jsonpack/sink.hpp"
+#include "jsonpack/util/simd.hpp"
 
 
 /**
@@ -64,7 +66,8 @@ static inline std::string trim(std::string s)
  */
 struct json_builder
 {
-    static inline void append_string(buffer &json, const char* key, const char* value)
+    template<typename Sink>
+    static inline void append_string(Sink &json, const char* key, const char* value)
     {
         json.append("\"" , 1);
         json.append( key, strlen(key) ); //key
@@ -74,6 +77,48 @@ struct json_builder
     }
 
 
+    /**
+     * Append the string content escaping '"', '\\' and control chars. Clean
+     * runs, found 16/32 bytes at a time, are copied in a single append, or
+     * referenced in place by the sinks able to (see sink_traits).
+     */
+    template<typename Sink>
+    static inline void append_escaped(Sink &json, const char* value, std::size_t len)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        const char* end = value + len;
+        while(value < end)
+        {
+            const char* special = find_escape(value, end);
+            if(special != value)    // clean run of the caller's string
+                sink_traits<Sink>::append_stable(json, value, special - value);
+
+            if(special == end)
+                break;
+
+            char c = *special;
+            switch(c)
+            {
+            case '"':  json.append("\\\"", 2); break;
+            case '\\': json.append("\\\\", 2); break;
+            case '\b': json.append("\\b", 2); break;
+            case '\f': json.append("\\f", 2); break;
+            case '\n': json.append("\\n", 2); break;
+            case '\r': json.append("\\r", 2); break;
+            case '\t': json.append("\\t", 2); break;
+            default:
+            {
+                char u[6] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xF], hex[c & 0xF]};
+                json.append(u, 6);
+                break;
+            }
+            }
+
+            value = special + 1;
+        }
+    }
+
     /**
      ***********************************  APPEND  **************************************
      ************************************************************************************/
@@ -81,8 +126,8 @@ struct json_builder
     /**
      * Append integer value to json like ("key":value,)
      */
-    template<typename Integer>
-    static void append_integer(buffer &json, const char *key, const Integer &value)
+    template<typename Sink, typename Integer>
+    static void append_integer(Sink &json, const char *key, const Integer &value)
     {
         fmt::FormatInt formater(value);
 
@@ -96,8 +141,8 @@ struct json_builder
     /**
      * Append integer value to json like (value,)
      */
-    template<typename Integer>
-    static void append_integer(buffer &json, const Integer &value)
+    template<typename Sink, typename Integer>
+    static void append_integer(Sink &json, const Integer &value)
     {
         fmt::FormatInt formater(value);
         json.append( formater.c_str(), formater.size() ); //value
@@ -108,8 +153,8 @@ struct json_builder
     /**
      * Append real value to json
      */
-    template<typename Real>
-    static void append_real(buffer &json, const char *key, const Real &value)
+    template<typename Sink, typename Real>
+    static void append_real(Sink &json, const char *key, const Real &value)
     {
         char buf[DOUBLE_MAX_DIGITS + 2] ; //signs
 
@@ -122,8 +167,8 @@ struct json_builder
         json.append(",", 1);
     }
 
-    template<typename Real>
-    static void append_real(buffer &json, const Real &value)
+    template<typename Sink, typename Real>
+    static void append_real(Sink &json, const Real &value)
     {
         char buf[DOUBLE_MAX_DIGITS + 2] ; //signs
 
@@ -133,6 +178,87 @@ struct json_builder
         json.append(",", 1);
     }
 
+    /**
+     ***********************************  SIZE  ****************************************
+     ************************************************************************************/
+
+    /**
+     * Size of "key": before a value
+     */
+    static inline std::size_t key_size(const char *key)
+    {
+        return strlen(key) + 3;
+    }
+
+    /**
+     * Number of decimal digits of n. The bit length gives log10(n) up to one
+     * (1233 / 4096 ~ log10(2)), a table of powers of ten does the correction.
+     */
+    static inline std::size_t count_digits(uint64_t n)
+    {
+        static const uint64_t powers[] = {
+            0ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+            100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+            10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+            10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+            10000000000000000000ULL
+        };
+
+        std::size_t t = ((last_bit64(n | 1) + 1) * 1233) >> 12;
+        return t + 1 - (n < powers[t] ? 1 : 0);
+    }
+
+    /**
+     * Size of the integer as written by append_integer, without the comma
+     */
+    static inline std::size_t integer_size(long long value)
+    {
+        return value < 0 ? 1 + count_digits( 0ULL - static_cast<unsigned long long>(value) ) :
+                           count_digits( static_cast<unsigned long long>(value) );
+    }
+
+    static inline std::size_t integer_size(unsigned long long value)
+    {
+        return count_digits(value);
+    }
+
+    /**
+     * Size of the real as written by append_real, without the comma. The
+     * shortest representation is only known by formatting it.
+     */
+    template<typename Real>
+    static std::size_t real_size(const Real &value)
+    {
+        char buf[DOUBLE_MAX_DIGITS + 2] ; //signs
+
+        dtoa_milo(value, buf);
+        return strlen(buf);
+    }
+
+    /**
+     * Size of the string content as written by append_escaped
+     */
+    static inline std::size_t escaped_size(const char* value, std::size_t len)
+    {
+        std::size_t size = len;
+        const char* end = value + len;
+
+        for(value = find_escape(value, end); value < end; value = find_escape(value + 1, end))
+        {
+            switch(*value)
+            {
+            case '"': case '\\': case '\b': case '\f': case '\n': case '\r': case '\t':
+                size += 1;      // \X
+                break;
+            default:
+                size += 5;      // \u00XX
+                break;
+            }
+        }
+
+        return size;
+    }
+
 };
 
 JSONPACK_API_END_NAMESPACE // util
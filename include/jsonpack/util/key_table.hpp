@@ -0,0 +1,324 @@
+/**
+ *  Jsonpack - Compile time table of the attribute names
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_KEY_TABLE_HPP
+#define JSONPACK_KEY_TABLE_HPP
+
+#include <cstddef>
+#include <stdint.h>
+#include <string.h>
+
+#include "jsonpack/namespace.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+UTIL_BEGIN_NAMESPACE
+
+/**
+ * The attribute names are taken from the stringified DEFINE_JSON_ATTRIBUTES
+ * arguments, like "mFloat, mInt, mCad", wrapped in a type:
+ *
+ *   struct names { static constexpr const char* str() { return "mFloat, mInt, mCad"; } };
+ *
+ * and split at compile time by the constexpr functions below.
+ */
+
+constexpr bool is_key_separator(char c)
+{
+    return c == ',' || c == ' ' || c == '\t' || c == '\n';
+}
+
+constexpr std::size_t skip_key_separators(const char* s, std::size_t i)
+{
+    return is_key_separator(s[i]) ? skip_key_separators(s, i + 1) : i;
+}
+
+constexpr std::size_t key_end(const char* s, std::size_t i)
+{
+    return (s[i] == '\0' || is_key_separator(s[i])) ? i : key_end(s, i + 1);
+}
+
+/**
+ * Offset of the n-th name
+ */
+constexpr std::size_t key_begin(const char* s, std::size_t n, std::size_t i = 0)
+{
+    return n == 0 ? skip_key_separators(s, i)
+                  : key_begin(s, n - 1, key_end(s, skip_key_separators(s, i)));
+}
+
+/**
+ * Length of the n-th name
+ */
+constexpr std::size_t key_length(const char* s, std::size_t n)
+{
+    return key_end(s, key_begin(s, n)) - key_begin(s, n);
+}
+
+/**
+ * C++11 replacement of std::index_sequence
+ */
+template<std::size_t... I>
+struct index_sequence {};
+
+template<std::size_t N, std::size_t... I>
+struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {};
+
+template<std::size_t... I>
+struct make_index_sequence<0, I...>
+{
+    typedef index_sequence<I...> type;
+};
+
+/**
+ * Name at offset B with the JSON key syntax: "name":
+ */
+template<typename Names, std::size_t B, typename Seq>
+struct quoted_key;
+
+template<typename Names, std::size_t B, std::size_t... C>
+struct quoted_key<Names, B, index_sequence<C...> >
+{
+    static constexpr std::size_t size = sizeof...(C) + 3;
+    static constexpr char data[sizeof...(C) + 3] = { '"', Names::str()[B + C]..., '"', ':' };
+};
+
+template<typename Names, std::size_t B, std::size_t... C>
+constexpr std::size_t quoted_key<Names, B, index_sequence<C...> >::size;
+
+template<typename Names, std::size_t B, std::size_t... C>
+constexpr char quoted_key<Names, B, index_sequence<C...> >::data[];
+
+/**
+ * I-th attribute name, as a (pointer, length) pair and as the "name": fragment
+ * used by the serializer. Nothing is computed at run time.
+ */
+template<typename Names, std::size_t I>
+struct json_key
+{
+    static constexpr std::size_t begin = key_begin(Names::str(), I);
+    static constexpr std::size_t length = key_length(Names::str(), I);
+
+    typedef quoted_key<Names, begin, typename make_index_sequence<length>::type> quoted;
+
+    static const char* name()
+    {
+        return Names::str() + begin;
+    }
+};
+
+template<typename Names, std::size_t I>
+constexpr std::size_t json_key<Names, I>::begin;
+
+template<typename Names, std::size_t I>
+constexpr std::size_t json_key<Names, I>::length;
+
+/**
+ * ****************************** KEY DISPATCH *********************************
+ *
+ * Map an incoming key to the index of the attribute (member slot) with a
+ * perfect hash generated at compile time from the attribute names.
+ *
+ * The hash input is a 32 bits signature of the key: length, first, middle and
+ * last chars, hashed by a multiplication with a seed; the top bits index a
+ * table of 2 to 256 slots (about N^2 entries, so a seed is quickly found).
+ * A lookup costs one multiplication, one table load and one memcmp to confirm
+ * the match. If no seed is found, for example when two names have the same
+ * signature, the lookup falls back to a scan comparing lengths first.
+ */
+
+constexpr uint32_t key_signature(const char* s, std::size_t len)
+{
+    return len == 0 ? 0 :
+           ( static_cast<uint32_t>(len & 0xFF) |
+             (static_cast<uint32_t>(static_cast<unsigned char>(s[0])) << 8) |
+             (static_cast<uint32_t>(static_cast<unsigned char>(s[len / 2])) << 16) |
+             (static_cast<uint32_t>(static_cast<unsigned char>(s[len - 1])) << 24) );
+}
+
+constexpr unsigned key_table_bits(std::size_t n, unsigned bits = 1)
+{
+    return (bits == 8 || (std::size_t(1) << bits) >= n * n) ? bits : key_table_bits(n, bits + 1);
+}
+
+constexpr uint32_t key_bucket(uint32_t signature, uint32_t seed, unsigned bits)
+{
+    return static_cast<uint32_t>(signature * seed) >> (32 - bits);
+}
+
+constexpr uint32_t key_seed(uint32_t k)
+{
+    return static_cast<uint32_t>((2 * k + 1) * 0x9E3779B9u); // odd multipliers
+}
+
+constexpr uint64_t bucket_word(uint32_t b, uint64_t w0, uint64_t w1, uint64_t w2, uint64_t w3)
+{
+    return b < 64 ? w0 : b < 128 ? w1 : b < 192 ? w2 : w3;
+}
+
+constexpr uint64_t bucket_bit(uint32_t b)
+{
+    return uint64_t(1) << (b & 63);
+}
+
+/**
+ * Check that the n first signatures land in distinct buckets, w0..w3 hold the
+ * buckets already taken
+ */
+constexpr bool is_perfect(const uint32_t* sig, std::size_t n, uint32_t seed, unsigned bits,
+                          uint64_t w0 = 0, uint64_t w1 = 0, uint64_t w2 = 0, uint64_t w3 = 0);
+
+constexpr bool is_perfect_at(const uint32_t* sig, std::size_t n, uint32_t seed, unsigned bits, uint32_t b,
+                             uint64_t w0, uint64_t w1, uint64_t w2, uint64_t w3)
+{
+    return (bucket_word(b, w0, w1, w2, w3) & bucket_bit(b)) ? false :
+           is_perfect(sig, n - 1, seed, bits,
+                      b < 64 ? w0 | bucket_bit(b) : w0,
+                      b >= 64 && b < 128 ? w1 | bucket_bit(b) : w1,
+                      b >= 128 && b < 192 ? w2 | bucket_bit(b) : w2,
+                      b >= 192 ? w3 | bucket_bit(b) : w3);
+}
+
+constexpr bool is_perfect(const uint32_t* sig, std::size_t n, uint32_t seed, unsigned bits,
+                          uint64_t w0, uint64_t w1, uint64_t w2, uint64_t w3)
+{
+    return n == 0 ? true :
+           is_perfect_at(sig, n, seed, bits, key_bucket(sig[n - 1], seed, bits), w0, w1, w2, w3);
+}
+
+/**
+ * First seed in [lo, hi) giving a perfect hash, or 0. The range is split in
+ * halves to keep the constexpr recursion depth logarithmic.
+ */
+constexpr uint32_t find_key_seed(const uint32_t* sig, std::size_t n, unsigned bits, uint32_t lo, uint32_t hi);
+
+constexpr uint32_t find_key_seed_upper(uint32_t found, const uint32_t* sig, std::size_t n, unsigned bits,
+                                       uint32_t mid, uint32_t hi)
+{
+    return found != 0 ? found : find_key_seed(sig, n, bits, mid, hi);
+}
+
+constexpr uint32_t find_key_seed(const uint32_t* sig, std::size_t n, unsigned bits, uint32_t lo, uint32_t hi)
+{
+    return hi - lo == 1 ? ( is_perfect(sig, n, key_seed(lo), bits) ? key_seed(lo) : 0 ) :
+           find_key_seed_upper( find_key_seed(sig, n, bits, lo, lo + (hi - lo) / 2),
+                                sig, n, bits, lo + (hi - lo) / 2, hi );
+}
+
+/**
+ * Slot + 1 of the name stored in bucket b, 0 for an empty bucket
+ */
+constexpr unsigned char bucket_slot(const uint32_t* sig, std::size_t n, uint32_t seed, unsigned bits,
+                                    uint32_t b, std::size_t i = 0)
+{
+    return i == n ? 0 :
+           key_bucket(sig[i], seed, bits) == b ? static_cast<unsigned char>(i + 1) :
+           bucket_slot(sig, n, seed, bits, b, i + 1);
+}
+
+/**
+ * Offsets, lengths and signatures of the attribute names
+ */
+template<typename Names, typename Seq>
+struct key_names;
+
+template<typename Names, std::size_t... I>
+struct key_names<Names, index_sequence<I...> >
+{
+    static constexpr std::size_t begin[sizeof...(I)] = { key_begin(Names::str(), I)... };
+    static constexpr std::size_t length[sizeof...(I)] = { key_length(Names::str(), I)... };
+    static constexpr uint32_t signature[sizeof...(I)] =
+        { key_signature(Names::str() + key_begin(Names::str(), I), key_length(Names::str(), I))... };
+};
+
+template<typename Names, std::size_t... I>
+constexpr std::size_t key_names<Names, index_sequence<I...> >::begin[];
+
+template<typename Names, std::size_t... I>
+constexpr std::size_t key_names<Names, index_sequence<I...> >::length[];
+
+template<typename Names, std::size_t... I>
+constexpr uint32_t key_names<Names, index_sequence<I...> >::signature[];
+
+/**
+ * Bucket table of the perfect hash
+ */
+template<typename Names, std::size_t N, uint32_t Seed, unsigned Bits, typename Seq>
+struct key_buckets;
+
+template<typename Names, std::size_t N, uint32_t Seed, unsigned Bits, std::size_t... B>
+struct key_buckets<Names, N, Seed, Bits, index_sequence<B...> >
+{
+    typedef key_names<Names, typename make_index_sequence<N>::type> names;
+
+    static constexpr unsigned char slot[sizeof...(B)] =
+        { bucket_slot(names::signature, N, Seed, Bits, static_cast<uint32_t>(B))... };
+};
+
+template<typename Names, std::size_t N, uint32_t Seed, unsigned Bits, std::size_t... B>
+constexpr unsigned char key_buckets<Names, N, Seed, Bits, index_sequence<B...> >::slot[];
+
+/**
+ * Lookup of the N attribute names of Names
+ */
+template<typename Names, std::size_t N>
+struct key_dispatch
+{
+    typedef key_names<Names, typename make_index_sequence<N>::type> names;
+
+    static constexpr unsigned bits = key_table_bits(N);
+
+    // 0: no perfect hash, slots are limited to 255
+    static constexpr uint32_t seed = N < 256 ? find_key_seed(names::signature, N, bits, 0, 1024) : 0;
+
+    typedef key_buckets<Names, N, seed, bits, typename make_index_sequence<(std::size_t(1) << bits)>::type> buckets;
+
+    /**
+     * Index of the attribute named [key, key + len), or -1
+     */
+    static int find(const char* key, std::size_t len)
+    {
+        if(seed == 0)
+            return find_linear(key, len);
+
+        unsigned s = buckets::slot[ key_bucket(key_signature(key, len), seed, bits) ];
+
+        return ( s != 0 && names::length[s - 1] == len &&
+                 memcmp(Names::str() + names::begin[s - 1], key, len) == 0 ) ? static_cast<int>(s) - 1 : -1;
+    }
+
+    static int find_linear(const char* key, std::size_t len)
+    {
+        for(std::size_t i = 0; i < N; ++i)
+        {
+            if( names::length[i] == len && memcmp(Names::str() + names::begin[i], key, len) == 0 )
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+};
+
+template<typename Names, std::size_t N>
+constexpr unsigned key_dispatch<Names, N>::bits;
+
+template<typename Names, std::size_t N>
+constexpr uint32_t key_dispatch<Names, N>::seed;
+
+JSONPACK_API_END_NAMESPACE // util
+JSONPACK_API_END_NAMESPACE // jsonpack
+
+#endif // JSONPACK_KEY_TABLE_HPP
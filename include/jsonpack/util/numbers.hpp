@@ -0,0 +1,168 @@
+/**
+ *  Jsonpack - Number conversions from json text
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_NUMBERS_HPP
+#define JSONPACK_NUMBERS_HPP
+
+#include <limits>
+#include <stdint.h>
+#include <string.h>
+
+#include "jsonpack/namespace.hpp"
+
+#if defined(_MSC_VER) || \
+    (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define JSONPACK_LITTLE_ENDIAN
+#endif
+
+JSONPACK_API_BEGIN_NAMESPACE
+UTIL_BEGIN_NAMESPACE
+
+static inline bool is_digit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+#ifdef JSONPACK_LITTLE_ENDIAN
+/**
+ * Check that the 8 chars loaded in v are all ASCII digits
+ */
+static inline bool is_eight_digits(uint64_t v)
+{
+    return ( ( (v & 0xF0F0F0F0F0F0F0F0ULL) |
+               (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4) ) == 0x3333333333333333ULL );
+}
+
+/**
+ * Convert 8 ASCII digits loaded in v (first digit in the lowest byte)
+ * with three multiplications instead of eight
+ */
+static inline uint32_t parse_eight_digits(uint64_t v)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000ULL << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000ULL << 32)
+
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+
+    return static_cast<uint32_t>(v);
+}
+#endif
+
+/**
+ * Accumulate the decimal digits starting at p into acc, stopping at the
+ * first non digit char or at end. Return false on uint64_t overflow.
+ */
+static inline bool parse_digits(const char* &p, const char* end, uint64_t &acc)
+{
+#ifdef JSONPACK_LITTLE_ENDIAN
+    // 8 digits at once while the result fits in 19 digits
+    while(end - p >= 8 && acc < 100000000000ULL)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, p, 8);
+
+        if( !is_eight_digits(chunk) )
+            break;
+
+        acc = acc * 100000000ULL + parse_eight_digits(chunk);
+        p += 8;
+    }
+#endif
+
+    while(p < end && is_digit(*p))
+    {
+        uint64_t d = static_cast<uint64_t>(*p - '0');
+
+        if(acc > (std::numeric_limits<uint64_t>::max() - d) / 10)
+            return false;
+
+        acc = acc * 10 + d;
+        ++p;
+    }
+
+    return true;
+}
+
+/**
+ * Convert the integer text in [p, p + len) to Integer. As strtol does, the
+ * conversion stops at the first non digit char, so the integral part of a
+ * real is taken. Return false if there are no digits or the value does not
+ * fit in Integer.
+ */
+template<typename Integer>
+static inline bool parse_integer(const char* p, std::size_t len, Integer &value)
+{
+    const char* end = p + len;
+    bool negative = false;
+
+    if(p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    const char* digits = p;
+    uint64_t acc = 0;
+
+    if( !parse_digits(p, end, acc) || p == digits )
+        return false;
+
+    const uint64_t max = static_cast<uint64_t>( std::numeric_limits<Integer>::max() );
+
+    if(negative)
+    {
+        if( !std::numeric_limits<Integer>::is_signed )
+        {
+            if(acc != 0)
+                return false;
+
+            value = 0;
+            return true;
+        }
+
+        if(acc > max + 1)
+            return false;
+
+        // two's complement negation, valid for the minimum value too
+        value = static_cast<Integer>( 0 - acc );
+        return true;
+    }
+
+    if(acc > max)
+        return false;
+
+    value = static_cast<Integer>(acc);
+    return true;
+}
+
+/**
+ * Convert the real text in [p, p + len) to the nearest double/float, with
+ * round to nearest even as strtod, independently of the current locale.
+ * Return false if there are no digits or the value overflows.
+ */
+bool parse_real(const char* p, std::size_t len, double &value);
+
+bool parse_real(const char* p, std::size_t len, float &value);
+
+JSONPACK_API_END_NAMESPACE // util
+JSONPACK_API_END_NAMESPACE // jsonpack
+
+#endif // JSONPACK_NUMBERS_HPP
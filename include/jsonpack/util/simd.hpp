@@ -0,0 +1,276 @@
+/**
+ *  Jsonpack - Vectorized scanning primitives
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_SIMD_HPP
+#define JSONPACK_SIMD_HPP
+
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSONPACK_USE_AVX2
+#define JSONPACK_USE_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSONPACK_USE_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "jsonpack/namespace.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+UTIL_BEGIN_NAMESPACE
+
+/**
+ * Index of the lowest set bit, mask must be non zero
+ */
+static inline unsigned first_bit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+/**
+ * Index of the lowest set bit, mask must be non zero
+ */
+static inline unsigned first_bit64(uint64_t mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanForward64(&idx, mask);
+    return static_cast<unsigned>(idx);
+#elif defined(_MSC_VER)
+    uint32_t low = static_cast<uint32_t>(mask);
+    return low != 0 ? first_bit(low) : 32 + first_bit(static_cast<uint32_t>(mask >> 32));
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+/**
+ * Index of the highest set bit, mask must be non zero
+ */
+static inline unsigned last_bit64(uint64_t mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long idx;
+    _BitScanReverse64(&idx, mask);
+    return static_cast<unsigned>(idx);
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    uint32_t high = static_cast<uint32_t>(mask >> 32);
+    if(high != 0)
+    {
+        _BitScanReverse(&idx, high);
+        return 32 + static_cast<unsigned>(idx);
+    }
+    _BitScanReverse(&idx, static_cast<uint32_t>(mask));
+    return static_cast<unsigned>(idx);
+#else
+    return 63 - static_cast<unsigned>(__builtin_clzll(mask));
+#endif
+}
+
+/**
+ * Number of set bits
+ */
+static inline unsigned bit_count64(uint64_t mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<unsigned>(__popcnt64(mask));
+#elif defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt(static_cast<uint32_t>(mask)) + __popcnt(static_cast<uint32_t>(mask >> 32)));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+}
+
+/**
+ * Whitespace as accepted by the scanner (same set of std::isspace on "C" locale)
+ */
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/**
+ * Return a pointer to the first non whitespace char in [p, end), or end
+ */
+static inline const char* skip_space(const char* p, const char* end)
+{
+    // short runs (a single space after ':' or ',') are the common case
+    if(p == end || !is_space(*p))
+        return p;
+
+#ifdef JSONPACK_USE_AVX2
+    while(end - p >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i ws = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                                    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')),
+                                    _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))));
+        uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(ws));
+        if(mask != 0)
+        {
+            p += first_bit(mask);
+            if(!is_space(*p))   // '\v' and '\f' are rare enough for the scalar loop
+                return p;
+            break;
+        }
+        p += 32;
+    }
+#endif
+
+#ifdef JSONPACK_USE_SSE2
+    while(end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i ws = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                                 _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')),
+                                 _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))));
+        uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(ws)) & 0xFFFF;
+        if(mask != 0)
+        {
+            p += first_bit(mask);
+            if(!is_space(*p))
+                return p;
+            break;
+        }
+        p += 16;
+    }
+#endif
+
+    while(p < end && is_space(*p))
+        ++p;
+
+    return p;
+}
+
+/**
+ * Return a pointer to the first '"' or '\\' in [p, end), or end. Both are
+ * searched in the same pass, so escapes cost nothing on clean strings.
+ */
+static inline const char* find_quote_or_backslash(const char* p, const char* end)
+{
+#ifdef JSONPACK_USE_AVX2
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i slash32 = _mm256_set1_epi8('\\');
+    while(end - p >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32),
+                                    _mm256_cmpeq_epi8(chunk, slash32))));
+        if(mask != 0)
+            return p + first_bit(mask);
+        p += 32;
+    }
+#endif
+
+#ifdef JSONPACK_USE_SSE2
+    const __m128i quote16 = _mm_set1_epi8('"');
+    const __m128i slash16 = _mm_set1_epi8('\\');
+    while(end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quote16),
+                                 _mm_cmpeq_epi8(chunk, slash16))));
+        if(mask != 0)
+            return p + first_bit(mask);
+        p += 16;
+    }
+#endif
+
+    while(p < end && *p != '"' && *p != '\\')
+        ++p;
+
+    return p;
+}
+
+/**
+ * Chars that must be escaped inside a JSON string: '"', '\\' and control chars
+ */
+static inline bool needs_escape(char c)
+{
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+/**
+ * Return a pointer to the first char in [p, end) that must be escaped, or end
+ */
+static inline const char* find_escape(const char* p, const char* end)
+{
+#ifdef JSONPACK_USE_AVX2
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i slash32 = _mm256_set1_epi8('\\');
+    const __m256i ctrl32 = _mm256_set1_epi8(0x1F);
+    while(end - p >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i special = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32),
+                                    _mm256_cmpeq_epi8(chunk, slash32)),
+                    _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, ctrl32), ctrl32)); // c <= 0x1F
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+        if(mask != 0)
+            return p + first_bit(mask);
+        p += 32;
+    }
+#endif
+
+#ifdef JSONPACK_USE_SSE2
+    const __m128i quote16 = _mm_set1_epi8('"');
+    const __m128i slash16 = _mm_set1_epi8('\\');
+    const __m128i ctrl16 = _mm_set1_epi8(0x1F);
+    while(end - p >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quote16),
+                                 _mm_cmpeq_epi8(chunk, slash16)),
+                    _mm_cmpeq_epi8(_mm_max_epu8(chunk, ctrl16), ctrl16)); // c <= 0x1F
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+        if(mask != 0)
+            return p + first_bit(mask);
+        p += 16;
+    }
+#endif
+
+    while(p < end && !needs_escape(*p))
+        ++p;
+
+    return p;
+}
+
+JSONPACK_API_END_NAMESPACE // util
+JSONPACK_API_END_NAMESPACE // jsonpack
+
+#endif // JSONPACK_SIMD_HPP
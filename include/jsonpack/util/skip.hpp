@@ -0,0 +1,281 @@
+/**
+ *  Jsonpack - Skipping of unwanted values
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_SKIP_HPP
+#define JSONPACK_SKIP_HPP
+
+#include <string.h>
+
+#include "jsonpack/util/simd.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+UTIL_BEGIN_NAMESPACE
+
+/**
+ * Bitmaps of the chars of a 64 bytes block that matter to bracket matching,
+ * bit i stands for the char i of the block
+ */
+struct block_masks
+{
+    uint64_t _quote;
+    uint64_t _backslash;
+    uint64_t _open;     // '{' and '['
+    uint64_t _close;    // '}' and ']'
+};
+
+#ifdef JSONPACK_USE_AVX2
+static inline void half_masks(const char* p, uint32_t &quote, uint32_t &backslash, uint32_t &open, uint32_t &close)
+{
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+    // '[' 0x5B, ']' 0x5D, '{' 0x7B, '}' 0x7D: clearing bit 0x20 folds the braces on the brackets
+    __m256i folded = _mm256_and_si256(chunk, _mm256_set1_epi8(static_cast<char>(0xDF)));
+
+    quote = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'))));
+    backslash = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'))));
+    open = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('['))));
+    close = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8(']'))));
+}
+#elif defined(JSONPACK_USE_SSE2)
+static inline void quarter_masks(const char* p, uint32_t &quote, uint32_t &backslash, uint32_t &open, uint32_t &close)
+{
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i folded = _mm_and_si128(chunk, _mm_set1_epi8(static_cast<char>(0xDF)));
+
+    quote = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'))));
+    backslash = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))));
+    open = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, _mm_set1_epi8('['))));
+    close = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, _mm_set1_epi8(']'))));
+}
+#endif
+
+/**
+ * Classify the 64 chars at p
+ */
+static inline void load_block(const char* p, block_masks &m)
+{
+#ifdef JSONPACK_USE_AVX2
+    uint32_t q0, b0, o0, c0, q1, b1, o1, c1;
+    half_masks(p, q0, b0, o0, c0);
+    half_masks(p + 32, q1, b1, o1, c1);
+
+    m._quote = q0 | (static_cast<uint64_t>(q1) << 32);
+    m._backslash = b0 | (static_cast<uint64_t>(b1) << 32);
+    m._open = o0 | (static_cast<uint64_t>(o1) << 32);
+    m._close = c0 | (static_cast<uint64_t>(c1) << 32);
+#elif defined(JSONPACK_USE_SSE2)
+    m._quote = m._backslash = m._open = m._close = 0;
+    for(unsigned i = 0; i < 64; i += 16)
+    {
+        uint32_t q, b, o, c;
+        quarter_masks(p + i, q, b, o, c);
+
+        m._quote |= static_cast<uint64_t>(q) << i;
+        m._backslash |= static_cast<uint64_t>(b) << i;
+        m._open |= static_cast<uint64_t>(o) << i;
+        m._close |= static_cast<uint64_t>(c) << i;
+    }
+#else
+    m._quote = m._backslash = m._open = m._close = 0;
+    for(unsigned i = 0; i < 64; ++i)
+    {
+        uint64_t bit = 1ULL << i;
+        switch(p[i])
+        {
+        case '"': m._quote |= bit; break;
+        case '\\': m._backslash |= bit; break;
+        case '{': case '[': m._open |= bit; break;
+        case '}': case ']': m._close |= bit; break;
+        default: break;
+        }
+    }
+#endif
+}
+
+/**
+ * Mask of the chars preceded by an odd run of backslashes. escaped carries
+ * whether the first char of the next block is escaped.
+ */
+static inline uint64_t escaped_chars(uint64_t backslash, uint64_t &escaped)
+{
+    const uint64_t even_bits = 0x5555555555555555ULL;
+
+    backslash &= ~escaped;  // an escaped backslash does not start a run
+    uint64_t follows_escape = (backslash << 1) | escaped;
+
+    // the carry of the addition runs each odd starting sequence to its end
+    uint64_t odd_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t even_ends = odd_starts + backslash;
+    escaped = even_ends < odd_starts ? 1 : 0;
+
+    uint64_t invert = even_ends << 1;
+    return (even_bits ^ invert) & follows_escape;
+}
+
+/**
+ * Bit i set if an odd number of bits up to i are set in x
+ */
+static inline uint64_t prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/**
+ * Scan state of skip_container, kept between calls when the text of the
+ * container arrives in pieces
+ */
+struct skip_state
+{
+    explicit skip_state(char open = '{'):
+        _depth(1),
+        _escaped(0),
+        _in_string(0),
+        _kinds(0),
+        _known(0),
+        _root(open & 0x20),
+        _mismatch(false)
+    {}
+
+    uint64_t _depth;
+    uint64_t _escaped;      // first char of the block is escaped
+    uint64_t _in_string;    // all ones if the block starts inside a string
+    uint64_t _kinds;        // bit set for '{', bit 0 is the last container opened
+    unsigned _known;        // containers whose kind is in kinds
+    char _root;             // '{' and '}' have bit 0x20, '[' and ']' do not
+    bool _mismatch;         // a closing bracket did not match its opener
+};
+
+/**
+ * Scan the 64 chars at block: return the offset past the bracket closing
+ * the container, 0 if it is not closed in the block, -1 on a mismatch
+ */
+static inline int skip_block(const char* block, skip_state &s)
+{
+    block_masks m;
+    load_block(block, m);
+
+    uint64_t quote = m._quote & ~escaped_chars(m._backslash, s._escaped);
+    uint64_t string = prefix_xor(quote) ^ s._in_string;
+    s._in_string = static_cast<uint64_t>( static_cast<int64_t>(string) >> 63 );
+
+    uint64_t open = m._open & ~string;
+    uint64_t close = m._close & ~string;
+
+    if(bit_count64(close) < s._depth)
+    {
+        s._depth += bit_count64(open);
+        s._depth -= bit_count64(close);
+        s._known = 0;  // the order of the brackets of the block is not looked at
+        return 0;
+    }
+
+    uint64_t brackets = open | close;
+    while(brackets != 0)
+    {
+        unsigned i = first_bit64(brackets);
+        brackets &= brackets - 1;
+
+        uint64_t brace = (block[i] & 0x20) != 0;
+        if( (open >> i) & 1 )
+        {
+            ++s._depth;
+            s._kinds = (s._kinds << 1) | brace;
+            if(s._known < 64)
+                ++s._known;
+        }
+        else if(s._known > 0)
+        {
+            if( (s._kinds & 1) != brace )
+                return -1;
+            s._kinds >>= 1;
+            --s._known;
+            --s._depth;
+        }
+        else if(--s._depth == 0)
+        {
+            return (block[i] & 0x20) == s._root ? static_cast<int>(i) + 1 : -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Resumable skip_container: go on from p with the state of the previous
+ * calls. Return a pointer past the closing bracket, or nullptr if it is not
+ * found before end or s._mismatch is set. p is left past the whole 64 bytes
+ * blocks scanned, the next call starts there with the text appended after
+ * end.
+ */
+static inline const char* skip_container(const char* &p, const char* end, skip_state &s)
+{
+    for(; end - p >= 64; p += 64)
+    {
+        int r = skip_block(p, s);
+        if(r != 0)
+        {
+            s._mismatch = (r < 0);
+            return r > 0 ? p + r : nullptr;
+        }
+    }
+
+    if(p < end)     // last partial block, padded with spaces and scanned again next time
+    {
+        char tail[64];
+        memset(tail, ' ', sizeof(tail));
+        memcpy(tail, p, end - p);
+
+        skip_state t(s);
+        int r = skip_block(tail, t);
+        s._mismatch = (r < 0);
+        if(r > 0)
+            return p + r;
+    }
+
+    return nullptr;
+}
+
+/**
+ * Skip the rest of an object or array opened by the bracket open, p being
+ * anywhere inside it at depth one: return a pointer past the matching closing
+ * bracket, or nullptr if the brackets are not
+ * balanced before end or a closing bracket does not match the kind of the
+ * opening one. Only brackets and strings are looked at, the skipped text is
+ * not otherwise validated and nothing is allocated.
+ *
+ * The text is classified 64 bytes at a time into bitmaps: the quotes not
+ * escaped delimit the strings, and only the brackets outside strings are
+ * counted, one block at once unless the depth can reach zero in it. In the
+ * blocks walked bracket by bracket the kind of the last 64 opened containers
+ * is kept, so the brackets closed there are matched against their openers.
+ */
+static inline const char* skip_container(const char* p, const char* end, char open)
+{
+    skip_state s(open);
+    return skip_container(p, end, s);
+}
+
+JSONPACK_API_END_NAMESPACE // util
+JSONPACK_API_END_NAMESPACE // jsonpack
+
+#endif // JSONPACK_SKIP_HPP
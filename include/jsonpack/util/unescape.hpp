@@ -0,0 +1,176 @@
+/**
+ *  Jsonpack - Decoding of JSON string escapes
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_UNESCAPE_HPP
+#define JSONPACK_UNESCAPE_HPP
+
+#include <cstddef>
+#include <stdint.h>
+#include <string.h>
+
+#include "jsonpack/namespace.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+UTIL_BEGIN_NAMESPACE
+
+/**
+ * Value of the hex digit c, or -1
+ */
+static inline int hex_value(char c)
+{
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * Read the 4 hex digits of a \uXXXX escape
+ */
+static inline bool read_hex4(const char* p, uint32_t &code)
+{
+    code = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        int h = hex_value(p[i]);
+        if(h < 0)
+            return false;
+        code = (code << 4) | static_cast<uint32_t>(h);
+    }
+    return true;
+}
+
+/**
+ * Write the code point as UTF-8, return the number of bytes
+ */
+static inline std::size_t encode_utf8(uint32_t code, char* dst)
+{
+    if(code < 0x80)
+    {
+        dst[0] = static_cast<char>(code);
+        return 1;
+    }
+    if(code < 0x800)
+    {
+        dst[0] = static_cast<char>(0xC0 | (code >> 6));
+        dst[1] = static_cast<char>(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if(code < 0x10000)
+    {
+        dst[0] = static_cast<char>(0xE0 | (code >> 12));
+        dst[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        dst[2] = static_cast<char>(0x80 | (code & 0x3F));
+        return 3;
+    }
+    dst[0] = static_cast<char>(0xF0 | (code >> 18));
+    dst[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    dst[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    dst[3] = static_cast<char>(0x80 | (code & 0x3F));
+    return 4;
+}
+
+/**
+ * Decode the escape starting at src (pointing to the backslash) into dst.
+ * Advance src past the escape and return the number of bytes written,
+ * or 0 for an invalid escape. An escape never decodes to more bytes than
+ * it takes in the source.
+ */
+static inline std::size_t unescape_one(const char* &src, const char* end, char* dst)
+{
+    if(end - src < 2)
+        return 0;
+
+    char c = src[1];
+    src += 2;
+
+    switch(c)
+    {
+    case '"':  *dst = '"';  return 1;
+    case '\\': *dst = '\\'; return 1;
+    case '/':  *dst = '/';  return 1;
+    case 'b':  *dst = '\b'; return 1;
+    case 'f':  *dst = '\f'; return 1;
+    case 'n':  *dst = '\n'; return 1;
+    case 'r':  *dst = '\r'; return 1;
+    case 't':  *dst = '\t'; return 1;
+    case 'u':
+    {
+        uint32_t code;
+        if(end - src < 4 || !read_hex4(src, code))
+            return 0;
+        src += 4;
+
+        if(code >= 0xD800 && code <= 0xDBFF) // high surrogate, a low one must follow
+        {
+            uint32_t low;
+            if(end - src < 6 || src[0] != '\\' || src[1] != 'u' || !read_hex4(src + 2, low) ||
+               low < 0xDC00 || low > 0xDFFF)
+                return 0;
+            src += 6;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        else if(code >= 0xDC00 && code <= 0xDFFF) // unpaired low surrogate
+        {
+            return 0;
+        }
+
+        return encode_utf8(code, dst);
+    }
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Decode the escapes of the string literal content [src, src + len) into dst,
+ * which must have room for len bytes and may be src itself (in place
+ * decoding). On success out_len is the decoded length.
+ */
+static inline bool unescape(const char* src, std::size_t len, char* dst, std::size_t &out_len)
+{
+    const char* end = src + len;
+    char* out = dst;
+
+    while(src < end)
+    {
+        const char* bs = static_cast<const char*>( memchr(src, '\\', end - src) );
+        const char* stop = bs != nullptr ? bs : end;
+
+        if(out != src)
+            memmove(out, src, stop - src);
+        out += stop - src;
+        src = stop;
+
+        if(bs != nullptr)
+        {
+            std::size_t n = unescape_one(src, end, out);
+            if(n == 0)
+                return false;
+            out += n;
+        }
+    }
+
+    out_len = static_cast<std::size_t>(out - dst);
+    return true;
+}
+
+JSONPACK_API_END_NAMESPACE // util
+JSONPACK_API_END_NAMESPACE // jsonpack
+
+#endif // JSONPACK_UNESCAPE_HPP
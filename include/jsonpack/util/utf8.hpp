@@ -0,0 +1,279 @@
+/**
+ *  Jsonpack - UTF-8 validation of string literals
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef JSONPACK_UTF8_HPP
+#define JSONPACK_UTF8_HPP
+
+#include <string.h>
+
+#include "jsonpack/util/simd.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+UTIL_BEGIN_NAMESPACE
+
+/**
+ * Return a pointer to the first byte of the first invalid UTF-8 sequence in
+ * [p, end), or end. Overlong forms, surrogates, code points above U+10FFFF
+ * and truncated sequences are invalid (RFC 3629).
+ */
+static inline const char* find_invalid_utf8_scalar(const char* p, const char* end)
+{
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(p);
+    const unsigned char* e = reinterpret_cast<const unsigned char*>(end);
+
+    while(s < e)
+    {
+        unsigned char c = *s;
+
+        if(c < 0x80)
+        {
+            ++s;
+            continue;
+        }
+
+        std::size_t n;
+        unsigned char lo = 0x80, hi = 0xBF; // range of the second byte
+
+        if(c >= 0xC2 && c <= 0xDF)      n = 2;
+        else if(c == 0xE0)              { n = 3; lo = 0xA0; }
+        else if(c == 0xED)              { n = 3; hi = 0x9F; }
+        else if(c >= 0xE1 && c <= 0xEF) n = 3;
+        else if(c == 0xF0)              { n = 4; lo = 0x90; }
+        else if(c == 0xF4)              { n = 4; hi = 0x8F; }
+        else if(c >= 0xF1 && c <= 0xF3) n = 4;
+        else
+            return reinterpret_cast<const char*>(s);
+
+        if(static_cast<std::size_t>(e - s) < n || s[1] < lo || s[1] > hi)
+            return reinterpret_cast<const char*>(s);
+
+        for(std::size_t i = 2; i < n; ++i)
+        {
+            if((s[i] & 0xC0) != 0x80)
+                return reinterpret_cast<const char*>(s);
+        }
+
+        s += n;
+    }
+
+    return end;
+}
+
+#ifdef JSONPACK_USE_AVX2
+/**
+ * Lookup-table UTF-8 validation of 32 bytes at a time, see John Keiser and
+ * Daniel Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte",
+ * Software: Practice and Experience 51 (5), 2021.
+ * Each byte pair (previous byte, current byte) is classified with three
+ * 16-entry tables indexed by nibbles; any bit surviving the AND is an error.
+ */
+struct utf8_checker
+{
+    __m256i _error;
+    __m256i _prev_input;
+    __m256i _prev_incomplete;
+
+    utf8_checker():
+        _error(_mm256_setzero_si256()),
+        _prev_input(_mm256_setzero_si256()),
+        _prev_incomplete(_mm256_setzero_si256())
+    {}
+
+    template<int N>
+    static inline __m256i prev(__m256i input, __m256i prev_input)
+    {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);
+    }
+
+    static inline __m256i high_nibble(__m256i v)
+    {
+        return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    static inline __m256i lookup(__m256i idx,
+                                 char t0, char t1, char t2, char t3, char t4, char t5, char t6, char t7,
+                                 char t8, char t9, char t10, char t11, char t12, char t13, char t14, char t15)
+    {
+        const __m256i table = _mm256_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15,
+                                               t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15);
+        return _mm256_shuffle_epi8(table, idx);
+    }
+
+    static inline __m256i check_special_cases(__m256i input, __m256i prev1)
+    {
+        const char TOO_SHORT = 1 << 0;  // lead byte followed by a lead byte or ASCII
+        const char TOO_LONG = 1 << 1;   // ASCII followed by a continuation
+        const char OVERLONG_3 = 1 << 2;
+        const char TOO_LARGE = 1 << 3;
+        const char SURROGATE = 1 << 4;
+        const char OVERLONG_2 = 1 << 5;
+        const char TOO_LARGE_1000 = 1 << 6;
+        const char OVERLONG_4 = 1 << 6;
+        const char TWO_CONTS = static_cast<char>(1 << 7);
+        const char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+        __m256i byte_1_high = lookup(high_nibble(prev1),
+                    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+                    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+                    TOO_SHORT | OVERLONG_2,
+                    TOO_SHORT,
+                    TOO_SHORT | OVERLONG_3 | SURROGATE,
+                    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+
+        __m256i byte_1_low = lookup(_mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)),
+                    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+                    CARRY | OVERLONG_2,
+                    CARRY,
+                    CARRY,
+                    CARRY | TOO_LARGE,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000,
+                    CARRY | TOO_LARGE | TOO_LARGE_1000);
+
+        __m256i byte_2_high = lookup(high_nibble(input),
+                    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+                    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+                    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+                    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+                    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+                    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+        return _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+    }
+
+    /**
+     * Third and fourth bytes of 3/4 bytes sequences must be continuations,
+     * which the two bytes tables above can not see
+     */
+    static inline __m256i check_multibyte_lengths(__m256i input, __m256i prev_input, __m256i sc)
+    {
+        __m256i prev2 = prev<2>(input, prev_input);
+        __m256i prev3 = prev<3>(input, prev_input);
+
+        __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        __m256i must23_80 = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte),
+                                             _mm256_set1_epi8(static_cast<char>(0x80)));
+
+        return _mm256_xor_si256(must23_80, sc);
+    }
+
+    /**
+     * Lead bytes in the last 3 positions whose sequence continues in the next block
+     */
+    static inline __m256i is_incomplete(__m256i input)
+    {
+        const __m256i max_value = _mm256_setr_epi8(
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+        return _mm256_subs_epu8(input, max_value);
+    }
+
+    inline void check_next(__m256i input)
+    {
+        if(_mm256_movemask_epi8(input) == 0) // ASCII block
+        {
+            _error = _mm256_or_si256(_error, _prev_incomplete);
+            _prev_input = input;
+            _prev_incomplete = _mm256_setzero_si256();
+            return;
+        }
+
+        __m256i prev1 = prev<1>(input, _prev_input);
+        __m256i sc = check_special_cases(input, prev1);
+        _error = _mm256_or_si256(_error, check_multibyte_lengths(input, _prev_input, sc));
+
+        _prev_incomplete = is_incomplete(input);
+        _prev_input = input;
+    }
+
+    inline bool valid()
+    {
+        __m256i e = _mm256_or_si256(_error, _prev_incomplete);
+        return _mm256_testz_si256(e, e) != 0;
+    }
+};
+#endif
+
+/**
+ * Return a pointer to the first byte of the first invalid UTF-8 sequence in
+ * [p, end), or end. The span is checked 32 bytes at a time (AVX2) or ASCII
+ * runs are skipped 16 bytes at a time (SSE2); the exact position of an error
+ * is then located by the scalar validator.
+ */
+static inline const char* find_invalid_utf8(const char* p, const char* end)
+{
+#if defined(JSONPACK_USE_AVX2)
+    utf8_checker checker;
+    const char* s = p;
+
+    while(end - s >= 32)
+    {
+        checker.check_next( _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)) );
+        s += 32;
+    }
+
+    if(s < end) // zero padded tail, zeros are ASCII
+    {
+        char tail[32];
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, s, end - s);
+        checker.check_next( _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)) );
+    }
+
+    return checker.valid() ? end : find_invalid_utf8_scalar(p, end);
+
+#elif defined(JSONPACK_USE_SSE2)
+    while(p < end)
+    {
+        while(end - p >= 16 &&
+              _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) == 0)
+            p += 16;
+
+        // validate up to the end of the current non ASCII run
+        const char* run = p;
+        while(run < end && (run - p < 16 || static_cast<unsigned char>(*run) >= 0x80))
+            ++run;
+
+        const char* bad = find_invalid_utf8_scalar(p, run);
+        if(bad != run)
+            return bad;
+        p = run;
+    }
+    return end;
+
+#else
+    return find_invalid_utf8_scalar(p, end);
+#endif
+}
+
+JSONPACK_API_END_NAMESPACE // util
+JSONPACK_API_END_NAMESPACE // jsonpack
+
+#endif // JSONPACK_UTF8_HPP
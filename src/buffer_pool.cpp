@@ -0,0 +1,99 @@
+/**
+ *  Jsonpack - Per thread pool of serialization buffers
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <vector>
+
+#include "jsonpack/buffer_pool.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/** ****************************************************************************
+ ******************************** BUFFER POOL **********************************
+ *******************************************************************************/
+
+#ifdef JSONPACK_HAS_THREAD_LOCAL
+
+/**
+ * Buffers released by the thread, freed at thread exit
+ */
+struct free_list
+{
+    free_list():
+        _buffers()
+    {}
+
+    ~free_list()
+    {
+        for(std::size_t i = 0; i < _buffers.size(); ++i)
+            delete _buffers[i];
+    }
+
+    std::vector<buffer*> _buffers;
+};
+
+static inline free_list& thread_free_list()
+{
+    static thread_local free_list list;
+    return list;
+}
+
+//---------------------------------------------------------------------------------------------------
+buffer* buffer_pool::acquire()
+{
+    std::vector<buffer*> &buffers = thread_free_list()._buffers;
+
+    if(buffers.empty())
+        return new buffer();
+
+    buffer* b = buffers.back();
+    buffers.pop_back();
+    return b;
+}
+
+//---------------------------------------------------------------------------------------------------
+void buffer_pool::release(buffer* b)
+{
+    std::vector<buffer*> &buffers = thread_free_list()._buffers;
+
+    if(buffers.size() >= max_pooled || b->capacity() > max_capacity)
+    {
+        delete b;
+        return;
+    }
+
+    b->clear();
+    buffers.push_back(b);
+}
+
+#else
+
+//---------------------------------------------------------------------------------------------------
+buffer* buffer_pool::acquire()
+{
+    return new buffer();
+}
+
+//---------------------------------------------------------------------------------------------------
+void buffer_pool::release(buffer* b)
+{
+    delete b;
+}
+
+#endif // JSONPACK_HAS_THREAD_LOCAL
+
+JSONPACK_API_END_NAMESPACE
@@ -0,0 +1,291 @@
+/**
+ *  Jsonpack - On demand access to a JSON document
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "jsonpack/lazy.hpp"
+#include "jsonpack/util/simd.hpp"
+#include "jsonpack/util/unescape.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/** ****************************************************************************
+ ******************************** LAZY VALUE ***********************************
+ *******************************************************************************/
+
+lazy_value lazy_value::find(const char* key, std::size_t len) const
+{
+    if(_doc == nullptr)
+        return lazy_value();
+
+    std::size_t pos = _doc->find(_pos, key, len);
+    return pos != lazy_doc::npos ? lazy_value(_doc, pos) : lazy_value();
+}
+
+//---------------------------------------------------------------------------------------------------
+lazy_value lazy_value::at(std::size_t index) const
+{
+    if(_doc == nullptr)
+        return lazy_value();
+
+    std::size_t pos = _doc->at(_pos, index);
+    return pos != lazy_doc::npos ? lazy_value(_doc, pos) : lazy_value();
+}
+
+//---------------------------------------------------------------------------------------------------
+jsonpack_token_type lazy_value::type() const
+{
+    return _doc != nullptr ? _doc->token_at(_pos) : JTK_INVALID;
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t lazy_value::size() const
+{
+    return _doc != nullptr ? _doc->size(_pos) : 0;
+}
+
+/** ****************************************************************************
+ ******************************** LAZY DOC *************************************
+ *******************************************************************************/
+
+lazy_doc::lazy_doc(const char* json, std::size_t len):
+    _json(json),
+    _len(len),
+    _root(0),
+    _s(),
+    _parser(),
+    _containers(),
+    _key()
+{
+    _s.init(json, len);
+    _root = static_cast<std::size_t>(util::skip_space(json, json + len) - json);
+
+    if(_root == len)
+        throw invalid_json("Empty json string");
+}
+
+//---------------------------------------------------------------------------------------------------
+jsonpack_token_type lazy_doc::token_at(std::size_t pos)
+{
+    _s.advance_to( static_cast<uint_fast32_t>(pos) );
+    return _s.next();
+}
+
+//---------------------------------------------------------------------------------------------------
+lazy_doc::container& lazy_doc::container_at(std::size_t pos)
+{
+    std::unordered_map<std::size_t, container>::iterator found = _containers.find(pos);
+
+    if(found == _containers.end())
+        found = _containers.insert( std::make_pair(pos, container(pos)) ).first;
+
+    return found->second;
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t lazy_doc::container_end(std::size_t pos)
+{
+    container &c = container_at(pos);
+
+    if(c._end == 0)
+    {
+        _s.advance_to( static_cast<uint_fast32_t>(pos + 1) );
+        if( !_s.skip_container(_json[pos]) )
+            throw invalid_json("Unbalanced brackets in value");
+
+        c._end = _s._i;
+    }
+
+    return c._end;
+}
+
+//---------------------------------------------------------------------------------------------------
+bool lazy_doc::next_member(container &c, bool object)
+{
+    _s.advance_to( static_cast<uint_fast32_t>(c._scan) );
+    jsonpack_token_type tk = _s.next();
+
+    if(tk == (object ? JTK_CLOSE_KEY : JTK_CLOSE_BRACKET))
+    {
+        c._done = true;
+        c._end = _s._i;
+        return false;
+    }
+
+    if( !c._members.empty() )
+    {
+        if(tk != JTK_COMMA)
+            throw invalid_json("Expect \",\" between values");
+        tk = _s.next();
+    }
+
+    member m;
+    m._key = 0;
+    m._key_len = 0;
+    m._escaped = false;
+
+    if(object)
+    {
+        if(tk != JTK_STRING_LITERAL)
+            throw invalid_json("Expect key \"String Literal\"");
+
+        m._key = _s._start_token_pos + 1;
+        m._key_len = _s._literal_end - m._key;
+        m._escaped = _s._escaped;
+
+        if(_s.next() != JTK_COLON)
+            throw invalid_json("Expect \":\" after key");
+        tk = _s.next();
+    }
+
+    if(tk == JTK_OPEN_KEY || tk == JTK_OPEN_BRACKET)
+    {
+        m._value = _s._i - 1;
+
+        // a container already walked by a lookup knows its end
+        std::unordered_map<std::size_t, container>::iterator found = _containers.find(m._value);
+        if(found != _containers.end() && found->second._end != 0)
+        {
+            _s.advance_to( static_cast<uint_fast32_t>(found->second._end) );
+        }
+        else if( !_s.skip_container(_json[m._value]) )
+        {
+            throw invalid_json("Unbalanced brackets in value");
+        }
+    }
+    else if(tk >= JTK_STRING_LITERAL && tk <= JTK_NULL)
+    {
+        m._value = _s._start_token_pos;
+    }
+    else
+    {
+        throw invalid_json("Expect valid JSON value");
+    }
+
+    c._scan = _s._i;
+    c._members.push_back(m);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------
+bool lazy_doc::key_equals(const member &m, const char* key, std::size_t len)
+{
+    const char* k = _json + m._key;
+
+    if( !m._escaped )
+        return m._key_len == len && memcmp(k, key, len) == 0;
+
+    std::size_t decoded;
+    _key.resize(m._key_len);
+
+    return util::unescape(k, m._key_len, &_key[0], decoded) &&
+            decoded == len && memcmp(_key.data(), key, len) == 0;
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t lazy_doc::find(std::size_t pos, const char* key, std::size_t len)
+{
+    if(token_at(pos) != JTK_OPEN_KEY)
+        return npos;
+
+    container &c = container_at(pos);
+
+    for(std::size_t i = 0; i < c._members.size(); ++i)
+    {
+        if( key_equals(c._members[i], key, len) )
+            return c._members[i]._value;
+    }
+
+    while( !c._done && next_member(c, true) )
+    {
+        if( key_equals(c._members.back(), key, len) )
+            return c._members.back()._value;
+    }
+
+    return npos;
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t lazy_doc::at(std::size_t pos, std::size_t index)
+{
+    if(token_at(pos) != JTK_OPEN_BRACKET)
+        return npos;
+
+    container &c = container_at(pos);
+
+    while( c._members.size() <= index && !c._done && next_member(c, false) )
+    {}
+
+    return index < c._members.size() ? c._members[index]._value : npos;
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t lazy_doc::size(std::size_t pos)
+{
+    jsonpack_token_type tk = token_at(pos);
+    if(tk != JTK_OPEN_KEY && tk != JTK_OPEN_BRACKET)
+        return 0;
+
+    container &c = container_at(pos);
+
+    while( !c._done && next_member(c, tk == JTK_OPEN_KEY) )
+    {}
+
+    return c._members.size();
+}
+
+//---------------------------------------------------------------------------------------------------
+char* lazy_doc::decode(std::size_t pos, jsonpack::value &v)
+{
+    jsonpack_token_type tk = token_at(pos);
+
+    if(tk >= JTK_STRING_LITERAL && tk <= JTK_NULL)
+    {
+        v = _s.get_last_value(tk == JTK_STRING_LITERAL);
+        v._pos._type = tk;
+        return const_cast<char*>(_json);
+    }
+
+    if(tk != JTK_OPEN_KEY && tk != JTK_OPEN_BRACKET)
+        throw invalid_json("Expect valid JSON value");
+
+    // only this subtree is parsed, the previous one is no longer needed
+    const char* json = _json + pos;
+    std::size_t len = container_end(pos) - pos;
+
+    _parser.reset();
+
+    bool ok;
+    if(tk == JTK_OPEN_KEY)
+    {
+        v._field = _OBJ;
+        v._obj = new_object(_parser.get_arena());
+        ok = _parser.json_validate(json, len, *v._obj);
+    }
+    else
+    {
+        v._field = _ARR;
+        v._arr = new_array(_parser.get_arena());
+        ok = _parser.json_validate(json, len, *v._arr);
+    }
+
+    if(!ok)
+        throw invalid_json( _parser.error_.c_str() );
+
+    return const_cast<char*>(json);
+}
+
+JSONPACK_API_END_NAMESPACE
@@ -28,6 +28,11 @@
 
 #include "jsonpack/exceptions.hpp"
 #include "jsonpack/parser.hpp"
+#include "jsonpack/tape.hpp"
+#include "jsonpack/util/simd.hpp"
+#include "jsonpack/util/skip.hpp"
+#include "jsonpack/util/unescape.hpp"
+#include "jsonpack/util/utf8.hpp"
 
 
 
@@ -63,6 +68,7 @@ static const std::string token_str[] =
 void scanner::init(const char* json, const std::size_t &len)
 {
     _size = len;
+    _bad_utf8 = std::string::npos;
     if(_size > 0)
     {
         _source = (_size != 0) ? json : nullptr;
@@ -77,11 +83,23 @@ void scanner::init(const char* json, const std::size_t &len)
 
 void scanner::advance()
 {
-    _c = _source[++_i];
+    ++_i;
+    _c = (_i < _size) ? _source[_i] : '\0';
+}
+
+void scanner::advance_to(uint_fast32_t i)
+{
+    _i = i;
+    _c = (_i < _size) ? _source[_i] : '\0';
 }
 
 jsonpack_token_type scanner::next()
 {
+    if( util::is_space(_c) )
+    {
+        advance_to( static_cast<uint_fast32_t>(util::skip_space(_source + _i, _source + _size) - _source) );
+    }
+
     switch ( _c )
     {
     case '{':
@@ -113,35 +131,102 @@ jsonpack_token_type scanner::next()
         break;
 
     default:
-        if(std::isspace(  _c ) )
+        return other_value();
+    }
+}
+
+jsonpack_token_type scanner::string_literal()
+{
+    _start_token_pos = _i;
+    _escaped = false;
+
+    const char* end = _source + _size;
+    const char* p = _source + _i + 1;
+    char* out = nullptr;    // in-situ mode: end of the decoded text, once an escape is found
+
+    while(true)
+    {
+        const char* found = util::find_quote_or_backslash(p, end);
+
+        if(found == end)
+            break;
+
+        if(_validate_utf8)
         {
-            advance();
-            return next();
+            const char* bad = util::find_invalid_utf8(p, found);
+            if(bad != found)
+            {
+                _bad_utf8 = static_cast<std::size_t>(bad - _source);
+                break;
+            }
+        }
+
+        if(out != nullptr)  // move the clean run behind the decoded text
+        {
+            memmove(out, p, found - p);
+            out += found - p;
+        }
+
+        if(*found == '"')
+        {
+            if( found < end - 1 )//last char must be '}' or ']'
+            {
+                _literal_end = static_cast<uint_fast32_t>( (out != nullptr ? out : found) - _source );
+                advance_to( static_cast<uint_fast32_t>(found - _source) + 1 );
+                return JTK_STRING_LITERAL;
+            }
+            break;
+        }
+
+        // backslash
+        if(_insitu)
+        {
+            if(out == nullptr)
+                out = const_cast<char*>(found);
+
+            std::size_t n = util::unescape_one(found, end, out);
+            if(n == 0)
+                break;
+
+            out += n;
+            p = found;
         }
         else
         {
-            return other_value();
+            _escaped = true;
+            p = found + 2;
+            if(p > end)
+                break;
         }
     }
+
+    advance_to(_size);
+    return JTK_INVALID;
 }
 
-jsonpack_token_type scanner::string_literal()
+bool scanner::skip_container(char open)
 {
-    _start_token_pos = _i;
-    advance();
-
-    while( _c != '"' && _i < _size )
+    const char* begin = _source + _i;
+    const char* end = util::skip_container(begin, _source + _size, open);
+    if(end == nullptr)
     {
-        advance();
+        advance_to(_size);
+        return false;
     }
 
-    if( _i < _size - 1 )//last char must be '}' or ']'
+    if(_validate_utf8)  // outside strings the text is plain ASCII, the whole span is checked at once
     {
-        advance();
-        return JTK_STRING_LITERAL;
+        const char* bad = util::find_invalid_utf8(begin, end);
+        if(bad != end)
+        {
+            _bad_utf8 = static_cast<std::size_t>(bad - _source);
+            advance_to(_size);
+            return false;
+        }
     }
 
-    return JTK_INVALID;
+    advance_to( static_cast<uint_fast32_t>(end - _source) );
+    return true;
 }
 
 jsonpack_token_type scanner::other_value()
@@ -198,6 +283,7 @@ jsonpack_token_type scanner::number()
             while( std::isdigit( _c ) && _i < _size );
 
             if(_c == '.') state = 2;
+            else if(_c == 'e' || _c == 'E') state = 4;
             else return JTK_INTEGER;
 
             break;
@@ -255,7 +341,7 @@ key scanner::get_last_key( bool expect_str_literal = false )
 
     key k;
     k._ptr = lex;
-    k._bytes = _i - _start_token_pos - 2*expect_str_literal;
+    k._bytes = expect_str_literal ? _literal_end - _start_token_pos - 1 : _i - _start_token_pos;
 
     return k;
 
@@ -266,8 +352,9 @@ value scanner::get_last_value(bool expect_str_literal = false)
     value p;
     position vpos;
     vpos._pos = _start_token_pos + expect_str_literal;
-    vpos._count = _i - _start_token_pos - 2*expect_str_literal;
+    vpos._count = expect_str_literal ? _literal_end - _start_token_pos - 1 : _i - _start_token_pos;
     vpos._type = JTK_INVALID; //avoiding initializer warnig
+    vpos._escaped = expect_str_literal && _escaped;
 
     p._pos = vpos;
     p._field = _POS;
@@ -280,10 +367,6 @@ value scanner::get_last_value(bool expect_str_literal = false)
  ******************************** PARSER ***************************************
  *******************************************************************************/
 
-jsonpack_token_type parser::_tk;
-scanner parser::_s;
-std::string parser::error_;
-
 //---------------------------------------------------------------------------------------------------
 bool parser::match(const jsonpack_token_type &token)
 {
@@ -302,6 +385,19 @@ bool parser::match(const jsonpack_token_type &token)
 }
 
 
+//---------------------------------------------------------------------------------------------------
+void parser::utf8_error()
+{
+    error_ = "Invalid UTF-8 sequence at byte offset ";
+    error_.append( std::to_string(_s._bad_utf8) );
+}
+
+//---------------------------------------------------------------------------------------------------
+void parser::reset()
+{
+    _arena.reset();
+}
+
 //---------------------------------------------------------------------------------------------------
 void parser::advance()
 {
@@ -317,7 +413,11 @@ bool parser::json_validate(const char *json,const std::size_t &len, object_t &me
     _s.init(json, len);
     advance();
 
-    return match(JTK_OPEN_KEY) && item_list(members) && match(JTK_CLOSE_KEY);
+    bool ok = match(JTK_OPEN_KEY) && item_list(members) && match(JTK_CLOSE_KEY);
+    if(!ok && _s._bad_utf8 != std::string::npos)
+        utf8_error();
+
+    return ok;
 }
 
 //---------------------------------------------------------------------------------------------------
@@ -328,7 +428,53 @@ bool parser::json_validate(const char *json,const std::size_t &len, array_t &ele
     _s.init(json, len);
     advance();
 
-    return match(JTK_OPEN_BRACKET) && array_list(elemets) && match(JTK_CLOSE_BRACKET);
+    bool ok = match(JTK_OPEN_BRACKET) && array_list(elemets) && match(JTK_CLOSE_BRACKET);
+    if(!ok && _s._bad_utf8 != std::string::npos)
+        utf8_error();
+
+    return ok;
+}
+
+//---------------------------------------------------------------------------------------------------
+bool parser::json_validate(const char *json, const std::size_t &len, tape &t)
+{
+    error_ = "";
+
+    _s.init(json, len);
+    advance();
+    t.start(json, _s._insitu);
+
+    bool ok = false;
+    if(_tk == JTK_OPEN_KEY || _tk == JTK_OPEN_BRACKET)
+    {
+        ok = tape_value(t);
+    }
+    else
+    {
+        error_ = "Expect \"{\" or \"[\", but found \"";
+        error_.append( token_str[_tk] );
+        error_.append("\"") ;
+    }
+
+    if(!ok && _s._bad_utf8 != std::string::npos)
+        utf8_error();
+
+    return ok;
+}
+
+//---------------------------------------------------------------------------------------------------
+bool parser::json_decode(const char *json, const std::size_t &len, object_visitor &visitor)
+{
+    error_ = "";
+
+    _s.init(json, len);
+    advance();
+
+    bool ok = match(JTK_OPEN_KEY) && decode_members(visitor) && match(JTK_CLOSE_KEY);
+    if(!ok && _s._bad_utf8 != std::string::npos)
+        utf8_error();
+
+    return ok;
 }
 
 //---------------------------------------------------------------------------------------------------
@@ -376,6 +522,17 @@ bool parser::item(object_t &members)
 
 //---------------------------------------------------------------------------------------------------
 bool parser::value(key k, object_t &members)
+{
+    jsonpack::value val;
+    if( !any_value(val) )
+        return false;
+
+    members[k] = val;    // add to the map
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------
+bool parser::any_value(jsonpack::value &val)
 {
     if( _tk == JTK_INTEGER ||
             _tk == JTK_REAL ||
@@ -384,14 +541,8 @@ bool parser::value(key k, object_t &members)
             _tk == JTK_FALSE ||
             _tk == JTK_NULL ) //literals
     {
-
-        /**
-         * Add value into the map with current key
-         */
-        jsonpack::value val = _s.get_last_value(_tk == JTK_STRING_LITERAL);
+        val = _s.get_last_value(_tk == JTK_STRING_LITERAL);
         val._pos._type = _tk;
-        members[k] = val;
-//        members.emplace_hint(members.end(), k, val);
 
         advance();
         return true;
@@ -401,23 +552,18 @@ bool parser::value(key k, object_t &members)
     {
         advance();
 
-        object_t* new_obj = new object_t();  // create obj
+        object_t* new_obj = new_object(_arena);  // create obj
 
         register bool object_ok = item_list(*new_obj);          //fill obj
 
         if(object_ok)
         {
-            jsonpack::value p;                                  //create value width field _obj
-            p._obj = new_obj;
-            p._field = _OBJ;
-
-            members[k] = p;                                     // add to the map
-//            members.emplace_hint(members.end(), k, p);
+            val._obj = new_obj;                                 //value width field _obj
+            val._field = _OBJ;
 
             return match(JTK_CLOSE_KEY);
         }
 
-        delete_object(new_obj);
         return false;
     }
 
@@ -425,21 +571,16 @@ bool parser::value(key k, object_t &members)
     {
         advance();
 
-        array_t* new_array = new array_t();   // create arr
+        array_t* new_arr = new_array(_arena);   // create arr
 
-        register bool array_ok = array_list(*new_array);         // fill arr
+        register bool array_ok = array_list(*new_arr);         // fill arr
         if(array_ok)
         {
-            jsonpack::value p;                                  //create value width field _arr
-            p._arr = new_array;
-            p._field = _ARR;
-
-            members[k] = p;                                     // add to the map
-//            members.emplace_hint(members.end(), k, p);
+            val._arr = new_arr;                                 //value width field _arr
+            val._field = _ARR;
 
             return match(JTK_CLOSE_BRACKET);
         }
-        delete_array(new_array);
         return false;
     }
 
@@ -451,26 +592,76 @@ bool parser::value(key k, object_t &members)
 }
 
 //---------------------------------------------------------------------------------------------------
-bool parser::array_list(array_t &elemets)
+bool parser::skip_value()
 {
-    if(_tk == JTK_CLOSE_BRACKET)
+    if( _tk == JTK_INTEGER ||
+            _tk == JTK_REAL ||
+            _tk == JTK_STRING_LITERAL ||
+            _tk == JTK_TRUE ||
+            _tk == JTK_FALSE ||
+            _tk == JTK_NULL ) //literals
+    {
+        advance();
         return true;
+    }
 
-    if( value(elemets) )
+    if( (_tk == JTK_OPEN_KEY || _tk == JTK_OPEN_BRACKET) && !_validate_skipped )
     {
-        if(_tk == JTK_COMMA )
+        if( !_s.skip_container(_tk == JTK_OPEN_KEY ? '{' : '[') )
         {
-            advance();
-            return array_list(elemets);
+            error_ = "Unbalanced brackets in value";
+            return false;
         }
+
+        advance();
         return true;
     }
-    return false;
 
+    if( _tk == JTK_OPEN_KEY || _tk == JTK_OPEN_BRACKET )  // PARSE_VALIDATE_SKIPPED
+    {
+        bool object = (_tk == JTK_OPEN_KEY);
+        jsonpack_token_type close = object ? JTK_CLOSE_KEY : JTK_CLOSE_BRACKET;
+        advance();
+
+        while(_tk != close)
+        {
+            if(object)
+            {
+                if(_tk != JTK_STRING_LITERAL)
+                {
+                    error_ = "Expect key \"";
+                    error_.append( token_str[JTK_STRING_LITERAL] );
+                    error_.append("\", but found \"");
+                    error_.append( token_str[_tk] );
+                    error_.append("\"") ;
+                    return false;
+                }
+
+                advance();
+                if( !match(JTK_COLON) )
+                    return false;
+            }
+
+            if( !skip_value() )
+                return false;
+
+            if(_tk != JTK_COMMA)
+                break;
+            advance();
+        }
+
+        return match(close);
+    }
+
+	error_ = "Expect valid JSON value , but found \"";
+	error_.append( token_str[_tk] );
+	error_.append("\"") ;
+
+    return false;
 }
 
 //---------------------------------------------------------------------------------------------------
-bool parser::value( array_t &elemets)
+bool parser::tape_value(tape &t)
 {
     if( _tk == JTK_INTEGER ||
             _tk == JTK_REAL ||
@@ -479,70 +670,139 @@ bool parser::value( array_t &elemets)
             _tk == JTK_FALSE ||
             _tk == JTK_NULL ) //literals
     {
-
-        /**
-         * Add value into the vector
-         */
-        jsonpack::value vpos = _s.get_last_value(_tk == JTK_STRING_LITERAL);
-        vpos._pos._type = _tk;
-        elemets.push_back(vpos);
-//        elemets.emplace_back(vpos);
-
+        t.push_scalar(_tk, _s.get_last_value(_tk == JTK_STRING_LITERAL)._pos);
         advance();
         return true;
     }
 
-    if( _tk == JTK_OPEN_KEY )
+    if( _tk == JTK_OPEN_KEY || _tk == JTK_OPEN_BRACKET )
     {
-        advance();
-
-        object_t* new_obj = new object_t();  // create obj
+        bool object = (_tk == JTK_OPEN_KEY);
+        jsonpack_token_type close = object ? JTK_CLOSE_KEY : JTK_CLOSE_BRACKET;
 
-        register bool object_ok = item_list(*new_obj);          //fill obj
+        std::size_t open = t.open_container(_tk);
+        std::size_t count = 0;
+        advance();
 
-        if(object_ok)
+        while(_tk != close)
         {
-            jsonpack::value p;                                  //create value width field _obj
-            p._obj = new_obj;
-            p._field = _OBJ;
+            if(object)
+            {
+                if(_tk != JTK_STRING_LITERAL)
+                {
+                    error_ = "Expect key \"";
+                    error_.append( token_str[JTK_STRING_LITERAL] );
+                    error_.append("\", but found \"");
+                    error_.append( token_str[_tk] );
+                    error_.append("\"") ;
+                    return false;
+                }
+
+                t.push_scalar(JTK_STRING_LITERAL, _s.get_last_value(true)._pos);
+                advance();
 
-            elemets.push_back(p);                               // add to the map
-//            elemets.emplace_back(p);
+                if( !match(JTK_COLON) )
+                    return false;
+            }
 
-            return match(JTK_CLOSE_KEY);
+            if( !tape_value(t) )
+                return false;
+            ++count;
+
+            if(_tk != JTK_COMMA)
+                break;
+            advance();
         }
 
-        delete_object(new_obj);
-        return false;
+        if( !match(close) )
+            return false;
+
+        t.close_container(open, close, count);
+        return true;
     }
 
-    if( _tk == JTK_OPEN_BRACKET )
+	error_ = "Expect valid JSON value , but found \"";
+	error_.append( token_str[_tk] );
+	error_.append("\"") ;
+
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------
+bool parser::decode_members(object_visitor &visitor)
+{
+    while(_tk != JTK_CLOSE_KEY)
     {
+        if(_tk != JTK_STRING_LITERAL)
+        {
+            error_ = "Expect key \"";
+            error_.append( token_str[JTK_STRING_LITERAL] );
+
+            error_.append("\", but found \"");
+            error_.append( token_str[_tk] );
+            error_.append("\"") ;
+
+            return false;
+        }
+
+        key k = _s.get_last_key(true);
         advance();
 
-        array_t* new_array = new array_t();   // create arr
+        if( !match(JTK_COLON) )
+            return false;
 
-        register bool array_ok = array_list(*new_array);         // fill arr
-        if(array_ok)
+        int slot = visitor.slot(k._ptr, k._bytes);
+        if(slot < 0)
         {
-            jsonpack::value p;                                  //create value width field _arr
-            p._arr = new_array;
-            p._field = _ARR;
-
-            elemets.push_back(p);                               // add to the vector
-//            elemets.emplace_back(p);
+            if( !skip_value() )
+                return false;
+        }
+        else
+        {
+            jsonpack::value val;
+            if( !any_value(val) )
+                return false;
 
-            return match(JTK_CLOSE_BRACKET);
+            visitor.member(slot, val);
         }
-        delete_array(new_array);
-        return false;
+
+        if(_tk != JTK_COMMA)
+            break;
+
+        advance();
     }
 
-	error_ = "Expect valid JSON value , but found \"";
-	error_.append( token_str[_tk] );
-	error_.append("\"") ;
+    return true;
+}
 
+//---------------------------------------------------------------------------------------------------
+bool parser::array_list(array_t &elemets)
+{
+    if(_tk == JTK_CLOSE_BRACKET)
+        return true;
+
+    if( value(elemets) )
+    {
+        if(_tk == JTK_COMMA )
+        {
+            advance();
+            return array_list(elemets);
+        }
+        return true;
+    }
     return false;
+
+}
+
+//---------------------------------------------------------------------------------------------------
+bool parser::value( array_t &elemets)
+{
+    jsonpack::value val;
+    if( !any_value(val) )
+        return false;
+
+    elemets.push_back(val);    // add to the vector
+    return true;
 }
 
 
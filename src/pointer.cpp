@@ -0,0 +1,515 @@
+/**
+ *  Jsonpack - JSON Pointer queries over parsed values
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "jsonpack/pointer.hpp"
+#include "jsonpack/util/numbers.hpp"
+#include "jsonpack/util/unescape.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+static void pointer_error(const char* what, const std::string &path)
+{
+    std::string msg = what;
+    msg.append(path);
+    throw invalid_pointer( msg.data() );
+}
+
+/**
+ * Array index of a reference token: digits without leading zeros
+ */
+static std::size_t token_index(const std::string &name)
+{
+    if( name.empty() || (name[0] == '0' && name.size() > 1) )
+        return static_cast<std::size_t>(-1);
+
+    std::size_t index;
+    const char* p = name.data();
+    for(std::size_t i = 0; i < name.size(); ++i)
+    {
+        if( !util::is_digit(p[i]) )
+            return static_cast<std::size_t>(-1);
+    }
+
+    if( !util::parse_integer(p, name.size(), index) )
+        return static_cast<std::size_t>(-1);
+
+    return index;
+}
+
+/**
+ * Bucket of obj holding the keys of the given hash, mapped as the standard
+ * library does. Return false if the mapping of the library is not known.
+ */
+static bool hash_bucket(const object_t &obj, std::size_t hash, std::size_t &bucket)
+{
+    std::size_t n = obj.bucket_count();
+#if defined(__GLIBCXX__)
+    bucket = hash % n;
+    return true;
+#elif defined(_LIBCPP_VERSION)
+    bucket = (n & (n - 1)) == 0 ? (hash & (n - 1)) : (hash < n ? hash : hash % n);
+    return true;
+#else
+    bucket = hash % n;
+    return false;
+#endif
+}
+
+/** ****************************************************************************
+ ******************************** JSON POINTER *********************************
+ *******************************************************************************/
+
+json_pointer::json_pointer(const char* path):
+    _path(path),
+    _tokens()
+{
+    compile();
+}
+
+json_pointer::json_pointer(const std::string &path):
+    _path(path),
+    _tokens()
+{
+    compile();
+}
+
+//---------------------------------------------------------------------------------------------------
+void json_pointer::compile()
+{
+    if( _path.empty() || _path[0] == '/' )
+        parse_pointer();
+    else
+        parse_dotted();
+}
+
+//---------------------------------------------------------------------------------------------------
+void json_pointer::add_token(const std::string &name)
+{
+    jsonpack::key k;
+    k._ptr = name.data();
+    k._bytes = name.size();
+
+    _tokens.push_back( token(name, key_hash()(k), token_index(name)) );
+}
+
+//---------------------------------------------------------------------------------------------------
+void json_pointer::parse_pointer()
+{
+    std::string name;
+
+    // the path starts with '/', each one begins a new token
+    for(std::size_t i = 1; i <= _path.size(); ++i)
+    {
+        if(i == _path.size() || _path[i] == '/')
+        {
+            add_token(name);
+            name.clear();
+        }
+        else if(_path[i] == '~')
+        {
+            if(i + 1 < _path.size() && _path[i + 1] == '0')
+                name += '~';
+            else if(i + 1 < _path.size() && _path[i + 1] == '1')
+                name += '/';
+            else
+                pointer_error("Invalid escape in JSON pointer: ", _path);
+            ++i;
+        }
+        else
+        {
+            name += _path[i];
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------
+void json_pointer::parse_dotted()
+{
+    std::size_t i = 0;
+
+    while(i < _path.size())
+    {
+        if(_path[i] == '[')
+        {
+            std::size_t close = _path.find(']', i);
+            std::string index = _path.substr(i + 1, close == std::string::npos ? 0 : close - i - 1);
+
+            if( close == std::string::npos || token_index(index) == npos )
+                pointer_error("Invalid index in path: ", _path);
+
+            add_token(index);
+            i = close + 1;
+        }
+        else
+        {
+            std::size_t stop = _path.find_first_of(".[", i);
+            if(stop == std::string::npos)
+                stop = _path.size();
+
+            if(stop == i)
+                pointer_error("Empty member name in path: ", _path);
+
+            add_token( _path.substr(i, stop - i) );
+            i = stop;
+        }
+
+        if(i < _path.size() && _path[i] == '.')
+        {
+            if(++i == _path.size())
+                pointer_error("Empty member name in path: ", _path);
+        }
+        else if(i < _path.size() && _path[i] != '[')
+        {
+            pointer_error("Invalid path: ", _path);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------
+const value* json_pointer::member(const object_t &obj, const token &t) const
+{
+    jsonpack::key k;
+    k._ptr = t._name.data();
+    k._bytes = t._name.size();
+
+    // look in the bucket of the hash computed once when the pointer was compiled
+    std::size_t b;
+    if( hash_bucket(obj, t._hash, b) )
+    {
+        for(object_t::const_local_iterator it = obj.begin(b); it != obj.end(b); ++it)
+        {
+            if(it->first == k)
+                return &it->second;
+        }
+        return nullptr;
+    }
+
+    object_t::const_iterator found = obj.find(k);
+    return found != obj.end() ? &found->second : nullptr;
+}
+
+//---------------------------------------------------------------------------------------------------
+const value* json_pointer::element(const array_t &arr, const token &t) const
+{
+    return t._index < arr.size() ? &arr[t._index] : nullptr;
+}
+
+//---------------------------------------------------------------------------------------------------
+const value* json_pointer::walk(const value* v, std::size_t first) const
+{
+    for(std::size_t i = first; i < _tokens.size() && v != nullptr; ++i)
+    {
+        if(v->_field == _OBJ)
+            v = member(*v->_obj, _tokens[i]);
+        else if(v->_field == _ARR)
+            v = element(*v->_arr, _tokens[i]);
+        else
+            v = nullptr;
+    }
+
+    return v;
+}
+
+//---------------------------------------------------------------------------------------------------
+const value* json_pointer::find(const value &root) const
+{
+    return walk(&root, 0);
+}
+
+//---------------------------------------------------------------------------------------------------
+const value* json_pointer::find(const object_t &root) const
+{
+    if(_tokens.empty())
+        return nullptr;
+
+    return walk(member(root, _tokens[0]), 1);
+}
+
+//---------------------------------------------------------------------------------------------------
+const value* json_pointer::find(const array_t &root) const
+{
+    if(_tokens.empty())
+        return nullptr;
+
+    return walk(element(root, _tokens[0]), 1);
+}
+
+/** ****************************************************************************
+ ******************************** PATH SET *************************************
+ *******************************************************************************/
+
+path_set::path_set():
+    _nodes(),
+    _targets(),
+    _pending(),
+    _remaining(0),
+    _json(nullptr),
+    _s(),
+    _parser(),
+    _key()
+{
+    _nodes.push_back( node(npos, std::string(), npos) );
+}
+
+//---------------------------------------------------------------------------------------------------
+void path_set::add_target(const json_pointer &path, path_target* dest)
+{
+    _targets.push_back( target(path.path(), dest) );
+
+    std::size_t id = 0;
+    ++_nodes[0]._total;
+
+    for(std::size_t i = 0; i < path._tokens.size(); ++i)
+    {
+        const json_pointer::token &t = path._tokens[i];
+
+        std::size_t next = npos;
+        for(std::size_t c = 0; c < _nodes[id]._children.size(); ++c)
+        {
+            if(_nodes[ _nodes[id]._children[c] ]._name == t._name)
+            {
+                next = _nodes[id]._children[c];
+                break;
+            }
+        }
+
+        if(next == npos)
+        {
+            next = _nodes.size();
+            _nodes.push_back( node(id, t._name, t._index) );
+            _nodes[id]._children.push_back(next);
+        }
+
+        id = next;
+        ++_nodes[id]._total;
+    }
+
+    _nodes[id]._targets.push_back( _targets.size() - 1 );
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t path_set::child_for_key(const node &n, const char* key, std::size_t len, bool escaped)
+{
+    if(escaped)
+    {
+        std::size_t decoded;
+        _key.resize(len);
+        if( !util::unescape(key, len, &_key[0], decoded) )
+            throw invalid_json("Invalid escape sequence in string");
+
+        key = _key.data();
+        len = decoded;
+    }
+
+    for(std::size_t c = 0; c < n._children.size(); ++c)
+    {
+        const std::string &name = _nodes[ n._children[c] ]._name;
+        if(name.size() == len && memcmp(name.data(), key, len) == 0)
+            return n._children[c];
+    }
+
+    return npos;
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t path_set::child_for_index(const node &n, std::size_t index)
+{
+    for(std::size_t c = 0; c < n._children.size(); ++c)
+    {
+        if(_nodes[ n._children[c] ]._index == index)
+            return n._children[c];
+    }
+
+    return npos;
+}
+
+//---------------------------------------------------------------------------------------------------
+void path_set::skip_value(jsonpack_token_type tk)
+{
+    if(tk == JTK_OPEN_KEY || tk == JTK_OPEN_BRACKET)
+    {
+        if( !_s.skip_container(tk == JTK_OPEN_KEY ? '{' : '[') )
+            throw invalid_json("Unbalanced brackets in value");
+    }
+    else if(tk < JTK_STRING_LITERAL || tk > JTK_NULL)
+    {
+        throw invalid_json("Expect valid JSON value");
+    }
+}
+
+//---------------------------------------------------------------------------------------------------
+void path_set::fill(std::size_t id, jsonpack_token_type tk, std::size_t start)
+{
+    jsonpack::value v;
+    char* json_ptr = const_cast<char*>(_json);
+
+    if(tk == JTK_OPEN_KEY || tk == JTK_OPEN_BRACKET)
+    {
+        // the container was just scanned, parse it alone
+        const char* json = _json + start;
+        std::size_t len = _s._i - start;
+        bool ok;
+
+        _parser.reset();
+        if(tk == JTK_OPEN_KEY)
+        {
+            v._field = _OBJ;
+            v._obj = new_object(_parser.get_arena());
+            ok = _parser.json_validate(json, len, *v._obj);
+        }
+        else
+        {
+            v._field = _ARR;
+            v._arr = new_array(_parser.get_arena());
+            ok = _parser.json_validate(json, len, *v._arr);
+        }
+
+        if(!ok)
+            throw invalid_json( _parser.error_.c_str() );
+
+        json_ptr = const_cast<char*>(json);
+    }
+    else
+    {
+        v = _s.get_last_value(tk == JTK_STRING_LITERAL);
+        v._pos._type = tk;
+    }
+
+    const std::vector<std::size_t> &targets = _nodes[id]._targets;
+    for(std::size_t i = 0; i < targets.size(); ++i)
+    {
+        target &t = _targets[ targets[i] ];
+
+        if( !t._dest->match_token_type(v) )
+        {
+            std::string msg = "Invalid value type for pointer: ";
+            msg.append(t._path);
+            throw type_error( msg.data() );
+        }
+
+        t._dest->extract(v, json_ptr);
+        t._found = true;
+    }
+
+    _remaining -= targets.size();
+    for(std::size_t n = id; n != npos; n = _nodes[n]._parent)
+        _pending[n] -= targets.size();
+}
+
+//---------------------------------------------------------------------------------------------------
+bool path_set::scan_value(std::size_t id, jsonpack_token_type tk)
+{
+    const node &n = _nodes[id];
+    bool container = (tk == JTK_OPEN_KEY || tk == JTK_OPEN_BRACKET);
+    std::size_t start = container ? _s._i - 1 : _s._start_token_pos;
+
+    if( container && _pending[id] > n._targets.size() )
+    {
+        if( !scan_container(id, tk == JTK_OPEN_KEY) )
+            return false;
+    }
+    else
+    {
+        skip_value(tk);
+    }
+
+    if( !n._targets.empty() )
+        fill(id, tk, start);
+
+    return _remaining > 0;
+}
+
+//---------------------------------------------------------------------------------------------------
+bool path_set::scan_container(std::size_t id, bool object)
+{
+    const node &n = _nodes[id];
+    const jsonpack_token_type close = object ? JTK_CLOSE_KEY : JTK_CLOSE_BRACKET;
+    std::size_t index = 0;
+
+    for(jsonpack_token_type tk = _s.next(); tk != close; tk = _s.next(), ++index)
+    {
+        if(index > 0)
+        {
+            if(tk != JTK_COMMA)
+                throw invalid_json("Expect \",\" between values");
+            tk = _s.next();
+        }
+
+        std::size_t child;
+        if(object)
+        {
+            if(tk != JTK_STRING_LITERAL)
+                throw invalid_json("Expect key \"String Literal\"");
+
+            const char* key = _json + _s._start_token_pos + 1;
+            child = child_for_key(n, key, _s._literal_end - _s._start_token_pos - 1, _s._escaped);
+
+            if(_s.next() != JTK_COLON)
+                throw invalid_json("Expect \":\" after key");
+            tk = _s.next();
+        }
+        else
+        {
+            child = child_for_index(n, index);
+        }
+
+        if(child != npos && _pending[child] > 0)
+        {
+            if( !scan_value(child, tk) )
+                return false;
+        }
+        else
+        {
+            skip_value(tk);
+        }
+
+        // nothing left below this container
+        if(_pending[id] == n._targets.size())
+        {
+            if( !_s.skip_container(object ? '{' : '[') )
+                throw invalid_json("Unbalanced brackets in value");
+            return true;
+        }
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------
+std::size_t path_set::extract(const char* json, const std::size_t &len)
+{
+    _pending.resize(_nodes.size());
+    for(std::size_t i = 0; i < _nodes.size(); ++i)
+        _pending[i] = _nodes[i]._total;
+
+    for(std::size_t i = 0; i < _targets.size(); ++i)
+        _targets[i]._found = false;
+
+    _remaining = _targets.size();
+    if(_remaining == 0)
+        return 0;
+
+    _json = json;
+    _s.init(json, len);
+
+    scan_value(0, _s.next());
+
+    return _targets.size() - _remaining;
+}
+
+JSONPACK_API_END_NAMESPACE
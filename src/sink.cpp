@@ -0,0 +1,266 @@
+/**
+ *  Jsonpack - Output sinks for the serializer
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "jsonpack/sink.hpp"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+static void write_fd(int fd, const char* data, std::size_t len)
+{
+    while(len > 0)
+    {
+#ifndef _WIN32
+        ssize_t n = ::write(fd, data, len);
+#else
+        int n = ::_write(fd, data, static_cast<unsigned int>(len > 0x7fffffff ? 0x7fffffff : len));
+#endif
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            throw io_error("Error writing to file descriptor");
+        }
+
+        data += n;
+        len -= static_cast<std::size_t>(n);
+    }
+}
+
+static void write_file(FILE* file, const char* data, std::size_t len)
+{
+    if(fwrite(data, 1, len, file) != len)
+        throw io_error("Error writing to file");
+}
+
+/** ****************************************************************************
+ ******************************** STREAM SINK **********************************
+ *******************************************************************************/
+
+stream_sink::stream_sink(int fd, std::size_t chunk_size):
+    stream_sink(write_callback(std::bind(write_fd, fd, std::placeholders::_1, std::placeholders::_2)), chunk_size)
+{}
+
+stream_sink::stream_sink(FILE* file, std::size_t chunk_size):
+    stream_sink(write_callback(std::bind(write_file, file, std::placeholders::_1, std::placeholders::_2)), chunk_size)
+{
+    _file = file;
+}
+
+stream_sink::stream_sink(const write_callback &write, std::size_t chunk_size):
+    _write(write),
+    _file(nullptr),
+    _data(nullptr),
+    _capacity(chunk_size > 0 ? chunk_size : 1),
+    _size(0),
+    _written(0)
+{
+    _data = static_cast<char*>( malloc(_capacity) );
+    if(!_data)
+        throw alloc_error();
+}
+
+//---------------------------------------------------------------------------------------------------
+stream_sink::~stream_sink()
+{
+    try
+    {
+        flush();
+    }
+    catch(...)
+    {
+    }
+
+    free(_data);
+}
+
+//---------------------------------------------------------------------------------------------------
+void stream_sink::spill(const char* data, std::size_t len)
+{
+    // the pending bytes are followed by data, nothing can erase them now
+    if(_size > 0)
+        _write(_data, _size);
+    _written += _size;
+    _size = 0;
+
+    if(len <= _capacity)
+    {
+        memcpy(_data, data, len);
+        _size = len;
+    }
+    else
+    {
+        _write(data, len - 1);
+        _written += len - 1;
+        _data[0] = data[len - 1];
+        _size = 1;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------
+void stream_sink::flush()
+{
+    if(_size > 0)
+    {
+        _write(_data, _size);
+        _written += _size;
+        _size = 0;
+    }
+
+    if(_file != nullptr && fflush(_file) != 0)
+        throw io_error("Error writing to file");
+}
+
+/** ****************************************************************************
+ ******************************** IOVEC SINK ***********************************
+ *******************************************************************************/
+
+const std::size_t iovec_sink::copy_all;
+
+iovec_sink::iovec_sink(std::size_t block_size, std::size_t ref_threshold):
+    _block_size(block_size > 0 ? block_size : 1),
+    _ref_threshold(ref_threshold > 0 ? ref_threshold : 1),
+    _blocks(),
+    _current(0),
+    _used(0),
+    _segment(0),
+    _size(0),
+    _iov()
+{
+    char* block = static_cast<char*>( malloc(_block_size) );
+    if(!block)
+        throw alloc_error();
+
+    _blocks.push_back(block);
+}
+
+//---------------------------------------------------------------------------------------------------
+iovec_sink::~iovec_sink()
+{
+    for(std::size_t i = 0; i < _blocks.size(); ++i)
+        free(_blocks[i]);
+}
+
+//---------------------------------------------------------------------------------------------------
+void iovec_sink::next_block()
+{
+    end_segment();
+
+    if(_current + 1 == _blocks.size())
+    {
+        char* block = static_cast<char*>( malloc(_block_size) );
+        if(!block)
+            throw alloc_error();
+
+        _blocks.push_back(block);
+    }
+
+    _current++;
+    _used = 0;
+    _segment = 0;
+}
+
+//---------------------------------------------------------------------------------------------------
+void iovec_sink::end_segment()
+{
+    if(_used > _segment)
+    {
+        io_vec v;
+        v.iov_base = _blocks[_current] + _segment;
+        v.iov_len = _used - _segment;
+        _iov.push_back(v);
+
+        _segment = _used;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------
+void iovec_sink::clear()
+{
+    _current = 0;
+    _used = 0;
+    _segment = 0;
+    _size = 0;
+    _iov.clear();
+}
+
+//---------------------------------------------------------------------------------------------------
+const io_vec* iovec_sink::iov()
+{
+    end_segment();
+    return _iov.data();
+}
+
+//---------------------------------------------------------------------------------------------------
+int iovec_sink::iov_count()
+{
+    end_segment();
+    return static_cast<int>( _iov.size() );
+}
+
+//---------------------------------------------------------------------------------------------------
+void iovec_sink::write_to(int fd)
+{
+    iov();
+
+#ifndef _WIN32
+    std::size_t first = 0;
+    while(first < _iov.size())
+    {
+        int count = static_cast<int>( (_iov.size() - first < IOV_MAX) ? _iov.size() - first : IOV_MAX );
+        ssize_t n = ::writev(fd, &_iov[first], count);
+
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            throw io_error("Error writing to file descriptor");
+        }
+
+        // skip the entries written, the rest of a partial one is written alone
+        // so the list stays unchanged
+        std::size_t done = static_cast<std::size_t>(n);
+        while(first < _iov.size() && done >= _iov[first].iov_len)
+            done -= _iov[first++].iov_len;
+
+        if(done > 0)
+        {
+            write_fd(fd, static_cast<const char*>(_iov[first].iov_base) + done, _iov[first].iov_len - done);
+            first++;
+        }
+    }
+#else
+    for(std::size_t i = 0; i < _iov.size(); ++i)
+        write_fd(fd, static_cast<const char*>(_iov[i].iov_base), _iov[i].iov_len);
+#endif
+}
+
+JSONPACK_API_END_NAMESPACE
@@ -0,0 +1,210 @@
+/**
+ *  Jsonpack - Streaming decoder for NDJSON and concatenated documents
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "jsonpack/stream.hpp"
+#include "jsonpack/util/simd.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+static std::size_t read_fd(int fd, char* buf, std::size_t len)
+{
+    while(true)
+    {
+#ifndef _WIN32
+        ssize_t n = ::read(fd, buf, len);
+#else
+        int n = ::_read(fd, buf, static_cast<unsigned int>(len > 0x7fffffff ? 0x7fffffff : len));
+#endif
+        if(n >= 0)
+            return static_cast<std::size_t>(n);
+
+        if(errno != EINTR)
+            throw io_error("Error reading from file descriptor");
+    }
+}
+
+static std::size_t read_file(FILE* file, char* buf, std::size_t len)
+{
+    std::size_t n = fread(buf, 1, len, file);
+
+    if(n == 0 && ferror(file))
+        throw io_error("Error reading from file");
+
+    return n;
+}
+
+/** ****************************************************************************
+ ******************************** STREAM READER ********************************
+ *******************************************************************************/
+
+stream_reader::stream_reader(int fd, std::size_t chunk_size, std::size_t max_document_size):
+    stream_reader(read_callback(std::bind(read_fd, fd, std::placeholders::_1, std::placeholders::_2)),
+                  chunk_size, max_document_size)
+{}
+
+stream_reader::stream_reader(FILE* file, std::size_t chunk_size, std::size_t max_document_size):
+    stream_reader(read_callback(std::bind(read_file, file, std::placeholders::_1, std::placeholders::_2)),
+                  chunk_size, max_document_size)
+{}
+
+stream_reader::stream_reader(const read_callback &read, std::size_t chunk_size, std::size_t max_document_size):
+    _read(read),
+    _parser(PARSE_INSITU),  // the documents live in our own buffer, escapes are decoded in place
+    _data(nullptr),
+    _alloc(0),
+    _size(0),
+    _begin(0),
+    _scan(0),
+    _chunk(chunk_size > 0 ? chunk_size : 65536),
+    _max_document(max_document_size),
+    _skip(),
+    _count(0)
+{}
+
+stream_reader::~stream_reader()
+{
+    if(_data != nullptr)
+        free(_data);
+}
+
+//---------------------------------------------------------------------------------------------------
+bool stream_reader::fill()
+{
+    // drop the bytes of the documents already returned
+    if(_begin > 0)
+    {
+        memmove(_data, _data + _begin, _size - _begin);
+        _size -= _begin;
+        _begin = 0;
+    }
+
+    if(_alloc - _size < _chunk)
+    {
+        std::size_t nsize = (_alloc * 2 > _size + _chunk) ? _alloc * 2 : _size + _chunk;
+
+        void* tmp = realloc(_data, nsize);
+        if(!tmp)
+        {
+            throw alloc_error();
+        }
+
+        _data = static_cast<char*>(tmp);
+        _alloc = nsize;
+    }
+
+    std::size_t n = _read(_data + _size, _alloc - _size);
+    _size += n;
+
+    return n > 0;
+}
+
+//---------------------------------------------------------------------------------------------------
+void stream_reader::skip_line()
+{
+    while(true)
+    {
+        const char* nl = static_cast<const char*>( memchr(_data + _begin, '\n', _size - _begin) );
+        if(nl != nullptr)
+        {
+            _begin = static_cast<std::size_t>(nl - _data) + 1;
+            return;
+        }
+
+        _begin = _size;
+        if( !fill() )
+            return;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------
+bool stream_reader::next_document(const char* &json, std::size_t &len)
+{
+    while(true)
+    {
+        if(_scan == 0) // looking for the start of a document
+        {
+            if(_begin < _size)
+                _begin = static_cast<std::size_t>( util::skip_space(_data + _begin, _data + _size) - _data );
+
+            if(_begin == _size)
+            {
+                if( !fill() )
+                    return false;
+                continue;
+            }
+
+            if(_data[_begin] != '{' && _data[_begin] != '[')
+            {
+                skip_line();    // the next call resumes at the following line
+                throw invalid_json("Expect \"{\" or \"[\" at the start of a document");
+            }
+
+            _skip = util::skip_state(_data[_begin]);
+            _scan = 1;
+        }
+
+        // whole blocks are scanned once, the partial last one again after the next read
+        const char* p = _data + _begin + _scan;
+        const char* end = util::skip_container(p, _data + _size, _skip);
+        _scan = static_cast<std::size_t>(p - (_data + _begin));
+
+        if(static_cast<std::size_t>((end != nullptr ? end - _data : _size) - _begin) > _max_document)
+        {
+            _scan = 0;
+            skip_line();
+            throw invalid_json("Document larger than the maximum size");
+        }
+
+        if(end != nullptr)
+        {
+            json = _data + _begin;
+            len = static_cast<std::size_t>(end - json);
+
+            _begin += len;
+            _scan = 0;
+            ++_count;
+            return true;
+        }
+
+        if(_skip._mismatch)
+        {
+            _scan = 0;
+            skip_line();
+            throw invalid_json("Mismatched brackets in document");
+        }
+
+        if( !fill() )
+        {
+            _begin = _size;
+            _scan = 0;
+            throw invalid_json("Truncated document at the end of the stream");
+        }
+    }
+}
+
+JSONPACK_API_END_NAMESPACE
@@ -0,0 +1,124 @@
+/**
+ *  Jsonpack - Flat tape representation of parsed documents
+ *
+ *  Copyright (c) 2015 Yadiel Martinez Gonzalez <ymglez2015@gmail.com>
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "jsonpack/tape.hpp"
+#include "jsonpack/util/unescape.hpp"
+
+JSONPACK_API_BEGIN_NAMESPACE
+
+/** ****************************************************************************
+ ******************************** TAPE *****************************************
+ *******************************************************************************/
+
+void tape::to_value(std::size_t i, jsonpack::value &v)
+{
+    uint64_t word = _words[i];
+    jsonpack_token_type tk = tag(word);
+
+    if(tk == JTK_OPEN_KEY)
+    {
+        v._field = _OBJ;
+        v._obj = new_object(_arena);
+
+        for(std::size_t m = i + 2; m + 1 < payload(word); )
+        {
+            jsonpack::key k;
+            k._ptr = _json + payload(_words[m]);
+            k._bytes = static_cast<std::size_t>(_words[m + 1] & ~escaped_bit);
+
+            jsonpack::value &member = (*v._obj)[k];
+            to_value(m + 2, member);
+
+            m = next(m + 2);
+        }
+    }
+    else if(tk == JTK_OPEN_BRACKET)
+    {
+        v._field = _ARR;
+        v._arr = new_array(_arena);
+        v._arr->reserve( static_cast<std::size_t>(_words[i + 1]) );
+
+        for(std::size_t e = i + 2; e + 1 < payload(word); e = next(e))
+        {
+            v._arr->push_back( jsonpack::value() );
+            to_value(e, v._arr->back());
+        }
+    }
+    else
+    {
+        v._field = _POS;
+        v._pos._type = tk;
+        v._pos._pos = payload(word);
+        v._pos._escaped = false;
+        v._pos._count = 0;
+
+        if(tk == JTK_STRING_LITERAL || tk == JTK_INTEGER || tk == JTK_REAL)
+        {
+            v._pos._escaped = (_words[i + 1] & escaped_bit) != 0;
+            v._pos._count = static_cast<unsigned long>(_words[i + 1] & ~escaped_bit);
+        }
+    }
+}
+
+/** ****************************************************************************
+ ******************************** TAPE REF *************************************
+ *******************************************************************************/
+
+tape_ref tape_ref::find(const char* key, std::size_t len) const
+{
+    if(type() != JTK_OPEN_KEY)
+        return tape_ref();
+
+    const std::vector<uint64_t> &words = _tape->_words;
+    std::size_t end = tape::payload(words[_i]) - 1;
+    std::string decoded;
+
+    for(std::size_t m = _i + 2; m < end; m = _tape->next(m + 2))
+    {
+        const char* k = _tape->_json + tape::payload(words[m]);
+        std::size_t k_len = static_cast<std::size_t>(words[m + 1] & ~tape::escaped_bit);
+
+        if(words[m + 1] & tape::escaped_bit)
+        {
+            decoded.resize(k_len);
+            if( !util::unescape(k, k_len, &decoded[0], k_len) )
+                continue;
+            k = decoded.data();
+        }
+
+        if(k_len == len && memcmp(k, key, len) == 0)
+            return tape_ref(_tape, m + 2);
+    }
+
+    return tape_ref();
+}
+
+//---------------------------------------------------------------------------------------------------
+tape_ref tape_ref::at(std::size_t index) const
+{
+    if(type() != JTK_OPEN_BRACKET || index >= size())
+        return tape_ref();
+
+    std::size_t e = _i + 2;
+    for(std::size_t n = 0; n < index; ++n)
+        e = _tape->next(e);   // the skip links jump over nested containers
+
+    return tape_ref(_tape, e);
+}
+
+JSONPACK_API_END_NAMESPACE
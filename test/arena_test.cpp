@@ -0,0 +1,49 @@
+/**
+ *  Jsonpack - arena tests
+ */
+
+#include <stdint.h>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+static bool aligned(void* p, std::size_t align)
+{
+    return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+/**
+ * An aligned allocation at the end of a full chunk goes to a new chunk
+ * instead of past the end of the current one
+ */
+static void alignment_past_the_end()
+{
+    for(std::size_t fill = 1; fill <= 64; ++fill)
+    {
+        jsonpack::arena a(64);
+        char* first = static_cast<char*>( a.allocate(1, 1) );
+        char* last = first;
+
+        for(std::size_t i = 1; i < fill; ++i)
+            last = static_cast<char*>( a.allocate(1, 1) );
+
+        char* p = static_cast<char*>( a.allocate(8, 64) );
+        CHECK(aligned(p, 64));
+
+        // either in the first chunk, after the bytes taken, or in a new one
+        bool in_first = p > last && p + 8 <= first + 64;
+        bool elsewhere = p + 8 <= first || p >= first + 64;
+        CHECK(in_first || elsewhere);
+
+        for(int i = 0; i < 8; ++i)
+            p[i] = 'x';
+    }
+}
+
+int main()
+{
+    alignment_past_the_end();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+/**
+ *  Jsonpack - json_unpack validation tests
+ */
+
+#include <cstring>
+#include <string>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+struct Bound
+{
+    Bound(): i(0), s() {}
+
+    int i;
+    std::string s;
+
+    DEFINE_JSON_ATTRIBUTES(i, s)
+};
+
+/**
+ * Whether json_unpack accepts the text with a parser of the given flags
+ */
+static bool unpacked(const char* json, Bound &b, unsigned flags = jsonpack::PARSE_DEFAULT)
+{
+    jsonpack::parser p(flags);
+    try
+    {
+        b.json_unpack(json, strlen(json), p);
+    }
+    catch(const jsonpack::invalid_json &)
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Whether json_validate (the parsing of the C++03 branch) accepts the text
+ */
+static bool validated(const char* json)
+{
+    jsonpack::parser p;
+    jsonpack::object_t members;
+    return p.json_validate(json, strlen(json), members);
+}
+
+/**
+ * The values of unknown keys go through the bracket skip: text that is not
+ * JSON inside them is not looked at, brackets in strings are not counted
+ */
+static void unknown_values_are_skipped()
+{
+    Bound b;
+    CHECK(unpacked("{\"zz\":{\"a\":[1 2 3], not json},\"i\":5}", b) && b.i == 5);
+    CHECK(unpacked("{\"zz\":{\"k\":\"}]\\\"[\"},\"i\":6,\"yy\":[]}", b) && b.i == 6);
+
+    std::string nested = "{\"zz\":";
+    for(int i = 0; i < 100; ++i)
+        nested += (i % 2) ? "{\"k\":" : "[";
+    for(int i = 99; i >= 0; --i)
+        nested += (i % 2) ? "}" : "]";
+    nested += ",\"i\":7}";
+    CHECK(unpacked(nested.c_str(), b) && b.i == 7);
+}
+
+int main()
+{
+    Bound b;
+
+    const char* good = "{\"i\":1,\"zz\":[1,{\"q\":[true]},\"x\"],\"s\":\"ok\"}";
+    CHECK(unpacked(good, b) && b.i == 1 && b.s == "ok");
+    CHECK(unpacked(good, b, jsonpack::PARSE_VALIDATE_SKIPPED) && validated(good));
+
+    // a bad value inside balanced brackets is only seen with PARSE_VALIDATE_SKIPPED
+    const char* commas = "{\"i\":1,\"zz\":[1,2,,,],\"s\":\"ok\"}";
+    CHECK(unpacked(commas, b));
+    CHECK(!unpacked(commas, b, jsonpack::PARSE_VALIDATE_SKIPPED) && !validated(commas));
+
+    const char* colon = "{\"zz\":{\"q\" 1},\"i\":9}";
+    CHECK(!unpacked(colon, b, jsonpack::PARSE_VALIDATE_SKIPPED) && !validated(colon));
+
+    // mismatched brackets are rejected in both modes
+    const char* brackets = "{\"zz\":{\"q\":[}]},\"i\":9}";
+    CHECK(!unpacked(brackets, b));
+    CHECK(!unpacked(brackets, b, jsonpack::PARSE_VALIDATE_SKIPPED) && !validated(brackets));
+
+    unknown_values_are_skipped();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,146 @@
+/**
+ *  Jsonpack - iovec_sink tests
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+struct Message
+{
+    Message(): id(0), name(), body(), parts() {}
+
+    int id;
+    std::string name;
+    std::string body;
+    std::vector<std::string> parts;
+
+    DEFINE_JSON_ATTRIBUTES(id, name, body, parts)
+};
+
+static std::string gathered(jsonpack::iovec_sink &sink)
+{
+    std::string out;
+    for(int i = 0; i < sink.iov_count(); ++i)
+        out.append(static_cast<const char*>(sink.iov()[i].iov_base), sink.iov()[i].iov_len);
+    return out;
+}
+
+/**
+ * Number of list entries pointing into [data, data + len)
+ */
+static int references(jsonpack::iovec_sink &sink, const std::string &s)
+{
+    int found = 0;
+    for(int i = 0; i < sink.iov_count(); ++i)
+    {
+        const char* base = static_cast<const char*>(sink.iov()[i].iov_base);
+        if(base >= s.data() && base < s.data() + s.size())
+            ++found;
+    }
+    return found;
+}
+
+static std::string packed(const Message &m)
+{
+    jsonpack::buffer json;
+    m.json_append(json);
+    return std::string(json.data(), json.size());
+}
+
+/**
+ * Strings of at least ref_threshold bytes are listed in place, shorter ones
+ * are copied into the blocks
+ */
+static void threshold()
+{
+    const std::size_t limit = 16;
+    Message m;
+    m.id = 42;
+    m.name = std::string(limit - 1, 'n');
+    m.body = std::string(limit, 'b');
+
+    jsonpack::iovec_sink sink(64, limit);
+    m.json_append(sink);
+
+    CHECK(gathered(sink) == packed(m));
+    CHECK(sink.size() == packed(m).size());
+    CHECK(references(sink, m.name) == 0);
+    CHECK(references(sink, m.body) == 1);
+
+    bool whole = false;
+    for(int i = 0; i < sink.iov_count(); ++i)
+        whole = whole || (sink.iov()[i].iov_base == m.body.data() && sink.iov()[i].iov_len == limit);
+    CHECK(whole);
+
+    // the escapes split a string in clean runs, each one is checked alone
+    m.body = std::string(20, 'a') + "\"" + std::string(limit - 1, 'c') + "\n" + std::string(limit, 'd');
+    sink.clear();
+    m.json_append(sink);
+    CHECK(gathered(sink) == packed(m));
+    CHECK(references(sink, m.body) == 2);
+
+    // copy_all never references
+    jsonpack::iovec_sink copies(64, jsonpack::iovec_sink::copy_all);
+    m.json_append(copies);
+    CHECK(gathered(copies) == packed(m));
+    CHECK(references(copies, m.body) == 0);
+}
+
+/**
+ * Referenced strings between copied bytes spanning many blocks, in arrays
+ * where the comma after the last element is erased
+ */
+static void segments()
+{
+    Message m;
+    m.name = "short";
+    m.body = std::string(300, 'x');
+    for(int i = 0; i < 40; ++i)
+        m.parts.push_back( std::string(static_cast<std::size_t>(i * 3), static_cast<char>('a' + i % 26)) );
+
+    jsonpack::iovec_sink sink(32, 20);
+    m.json_append(sink);
+    std::string expected = packed(m);
+
+    CHECK(gathered(sink) == expected);
+    CHECK(sink.size() == expected.size());
+    CHECK(references(sink, m.body) == 1);
+
+    int referenced = 0;
+    for(std::size_t i = 0; i < m.parts.size(); ++i)
+        referenced += references(sink, m.parts[i]);
+    CHECK(referenced == 33);     // the parts of 20 bytes and more
+
+    // the blocks are reused after clear
+    sink.clear();
+    CHECK(sink.size() == 0 && sink.iov_count() == 0);
+    m.parts.clear();
+    m.json_append(sink);
+    CHECK(gathered(sink) == packed(m));
+
+    // write_to gathers the same bytes
+    FILE* f = tmpfile();
+    if(f != nullptr)
+    {
+        sink.write_to(fileno(f));
+        std::vector<char> back(sink.size() + 1);
+        rewind(f);
+        std::size_t n = fread(back.data(), 1, back.size(), f);
+        CHECK(std::string(back.data(), n) == packed(m));
+        fclose(f);
+    }
+}
+
+int main()
+{
+    threshold();
+    segments();
+
+    return TEST_RESULT();
+}
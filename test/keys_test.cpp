@@ -0,0 +1,143 @@
+/**
+ *  Jsonpack - attribute key dispatch tests
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+// 300 int members a00 .. c99, more than the 255 slots of the perfect hash
+#define M10(p) p##0, p##1, p##2, p##3, p##4, p##5, p##6, p##7, p##8, p##9
+#define M100(p) M10(p##0), M10(p##1), M10(p##2), M10(p##3), M10(p##4), \
+                M10(p##5), M10(p##6), M10(p##7), M10(p##8), M10(p##9)
+
+// expand the member list before DEFINE_JSON_ATTRIBUTES stringizes it
+#define BIND_ATTRIBUTES(...) DEFINE_JSON_ATTRIBUTES(__VA_ARGS__)
+#define NAMES(...) #__VA_ARGS__
+#define EXPANDED_NAMES(...) NAMES(__VA_ARGS__)
+
+struct Wide
+{
+    int M100(a), M100(b), M100(c);
+
+    BIND_ATTRIBUTES(M100(a), M100(b), M100(c))
+};
+
+/**
+ * Keys with the same length, first, middle and last chars have the same
+ * signature, so no seed separates them; "ab" is a prefix of "abc"
+ */
+struct wide_names { static constexpr const char* str() { return EXPANDED_NAMES(M100(a), M100(b), M100(c)); } };
+
+struct Colliding
+{
+    Colliding(): axbyc(0), azbwc(0), ab(0), abc(0) {}
+
+    int axbyc;
+    int azbwc;
+    int ab;
+    int abc;
+
+    DEFINE_JSON_ATTRIBUTES(axbyc, azbwc, ab, abc)
+};
+
+struct colliding_names { static constexpr const char* str() { return "axbyc, azbwc, ab, abc"; } };
+
+struct Few
+{
+    Few(): id(0), name(), idx(0) {}
+
+    int id;
+    std::string name;
+    int idx;
+
+    DEFINE_JSON_ATTRIBUTES(id, name, idx)
+};
+
+struct few_names { static constexpr const char* str() { return "id, name, idx"; } };
+
+/**
+ * Unpack with json_decode and with the parsed map of json_validate
+ */
+template<typename T>
+static void unpack_both(const std::string &json, T &decoded, T &mapped)
+{
+    decoded.json_unpack(json.data(), json.size());
+
+    std::string copy = json;
+    jsonpack::parser p;
+    jsonpack::object_t members;
+    CHECK(p.json_validate(copy.data(), copy.size(), members));
+    mapped.json_unpack(members, &copy[0]);
+}
+
+static void wide_struct_uses_the_linear_scan()
+{
+    typedef jsonpack::util::key_dispatch<wide_names, 300> dispatch;
+    CHECK(dispatch::seed == 0);
+    CHECK(dispatch::find("a00", 3) == 0);
+    CHECK(dispatch::find("c99", 3) == 299);
+    CHECK(dispatch::find("c9", 2) == -1);
+    CHECK(dispatch::find("d00", 3) == -1);
+
+    std::string json = "{";
+    const char prefix[] = {'a', 'b', 'c'};
+    for(int i = 0; i < 300; ++i)
+    {
+        char key[8];
+        snprintf(key, sizeof(key), "%c%02d", prefix[i / 100], i % 100);
+        json += std::string(i ? "," : "") + "\"" + key + "\":" + std::to_string(i * 3);
+    }
+    json += ",\"zzz\":1}";
+
+    Wide decoded = Wide(), mapped = Wide();
+    unpack_both(json, decoded, mapped);
+    CHECK(decoded.a00 == 0 && decoded.a42 == 126 && decoded.b17 == 351 && decoded.c99 == 897);
+    CHECK(mapped.a00 == 0 && mapped.a42 == 126 && mapped.b17 == 351 && mapped.c99 == 897);
+
+    char* packed = decoded.json_pack();
+    CHECK(std::string(packed) == json.substr(0, json.size() - 9) + "}");
+    free(packed);
+}
+
+static void colliding_keys()
+{
+    typedef jsonpack::util::key_dispatch<colliding_names, 4> dispatch;
+    CHECK(dispatch::seed == 0);
+    CHECK(dispatch::find("azbwc", 5) == 1);
+    CHECK(dispatch::find("axbqc", 5) == -1);   // same signature, not a member
+    CHECK(dispatch::find("abc", 3) == 3);
+    CHECK(dispatch::find("abcd", 4) == -1);
+
+    Colliding decoded, mapped;
+    unpack_both("{\"axbqc\":9,\"azbwc\":2,\"abcd\":9,\"abc\":4,\"axbyc\":1,\"a\":9,\"ab\":3}", decoded, mapped);
+    CHECK(decoded.axbyc == 1 && decoded.azbwc == 2 && decoded.ab == 3 && decoded.abc == 4);
+    CHECK(mapped.axbyc == 1 && mapped.azbwc == 2 && mapped.ab == 3 && mapped.abc == 4);
+}
+
+static void perfect_hash()
+{
+    typedef jsonpack::util::key_dispatch<few_names, 3> dispatch;
+    CHECK(dispatch::seed != 0);
+    CHECK(dispatch::find("id", 2) == 0 && dispatch::find("name", 4) == 1 && dispatch::find("idx", 3) == 2);
+    CHECK(dispatch::find("ix", 2) == -1 && dispatch::find("i", 1) == -1 && dispatch::find("", 0) == -1);
+
+    Few decoded, mapped;
+    unpack_both("{\"idx\":3,\"nope\":[1],\"name\":\"n\",\"id\":1}", decoded, mapped);
+    CHECK(decoded.id == 1 && decoded.name == "n" && decoded.idx == 3);
+    CHECK(mapped.id == 1 && mapped.name == "n" && mapped.idx == 3);
+}
+
+int main()
+{
+    wide_struct_uses_the_linear_scan();
+    colliding_keys();
+    perfect_hash();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,118 @@
+/**
+ *  Jsonpack - lazy_doc tests
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <jsonpack.hpp>
+#include <jsonpack/lazy.hpp>
+
+#include "test.hpp"
+
+struct Point
+{
+    Point(): x(0), y(0) {}
+
+    int x;
+    int y;
+
+    DEFINE_JSON_ATTRIBUTES(x, y)
+};
+
+static const char* document =
+    "{\"skip\":{\"s\":\"}]\\\"[{\",\"t\":[[],{}]},"
+    "\"a\":{\"b\":[10,{\"c\":\"deep\"},[1,2,3],{\"x\":4,\"y\":5}],\"n\":null},"
+    "\"k\\u0065y\":7,"
+    "\"last\":\"end\"}";
+
+/**
+ * Later lookups resume the scan, earlier ones come from the remembered
+ * members, the order of the requests does not change the answers
+ */
+static void repeated_access()
+{
+    jsonpack::lazy_doc doc(document, strlen(document));
+
+    CHECK(doc["last"].get<std::string>() == "end");
+    CHECK(doc["a"]["b"][0].get<int>() == 10);
+    CHECK(doc["last"].get<std::string>() == "end");
+    CHECK(doc["a"]["b"][0].get<int>() == 10);
+
+    for(int i = 0; i < 3; ++i)
+    {
+        CHECK(doc["a"]["b"][2][i].get<int>() == i + 1);
+        CHECK(doc["a"]["b"][2][2 - i].get<int>() == 3 - i);
+    }
+
+    CHECK(doc["a"]["b"].size() == 4);
+    CHECK(doc["a"]["b"].size() == 4);
+    CHECK(doc.root().size() == 4);
+    CHECK(doc["key"].get<int>() == 7);
+    CHECK(doc["key"].get<int>() == 7);
+}
+
+static void nested_access()
+{
+    jsonpack::lazy_doc doc(document, strlen(document));
+
+    jsonpack::lazy_value b = doc["a"]["b"];
+    CHECK(b.type() == jsonpack::JTK_OPEN_BRACKET);
+    CHECK(b[1]["c"].get<std::string>() == "deep");
+    CHECK(b[1].type() == jsonpack::JTK_OPEN_KEY);
+    CHECK(doc["a"]["n"].type() == jsonpack::JTK_NULL);
+
+    // only the requested subtree is parsed by get()
+    Point p = b[3].get<Point>();
+    CHECK(p.x == 4 && p.y == 5);
+    CHECK(b[2].get< std::vector<int> >().size() == 3);
+
+    // values skipped by brackets on the way are not mistaken for members
+    CHECK(!doc["s"].exists());
+    CHECK(!doc["t"].exists());
+    CHECK(doc["skip"]["s"].get<std::string>() == "}]\"[{");
+    CHECK(doc["skip"]["t"][1].type() == jsonpack::JTK_OPEN_KEY);
+
+    // missing members, indexes past the end and indexing a scalar are empty
+    CHECK(!doc["a"]["missing"]);
+    CHECK(!b[4] && !b[-1]);
+    CHECK(!doc["last"]["x"] && !doc["key"][0]);
+    CHECK(!doc["missing"]["b"][0].exists());
+    CHECK(doc["missing"].type() == jsonpack::JTK_INVALID);
+    CHECK_THROWS(doc["missing"].get<int>(), jsonpack::type_error);
+    CHECK_THROWS(doc["last"].get<int>(), jsonpack::type_error);
+
+    const char* array = "[[1,[2,[3,[4]]]],5]";
+    jsonpack::lazy_doc nested(array, strlen(array));
+    CHECK(nested[0][1][1][1][0].get<int>() == 4);
+    CHECK(nested[1].get<int>() == 5);
+    CHECK(nested[0][1][1][0].get<int>() == 3);
+}
+
+/**
+ * Malformed text is reported when the scan reaches it, not before
+ */
+static void malformed()
+{
+    const char* json = "{\"a\":1,\"b\" 2,\"c\":3}";
+    jsonpack::lazy_doc doc(json, strlen(json));
+
+    CHECK(doc["a"].get<int>() == 1);
+    CHECK_THROWS(doc["c"], jsonpack::invalid_json);
+
+    // a member is found once its value is skipped
+    const char* open = "{\"a\":1,\"b\":[1,2";
+    jsonpack::lazy_doc unterminated(open, strlen(open));
+    CHECK(unterminated["a"].get<int>() == 1);
+    CHECK_THROWS(unterminated["b"], jsonpack::invalid_json);
+}
+
+int main()
+{
+    repeated_access();
+    nested_access();
+    malformed();
+
+    return TEST_RESULT();
+}
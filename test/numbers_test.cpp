@@ -0,0 +1,209 @@
+/**
+ *  Jsonpack - number decoding tests
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+template<typename T>
+struct Holder
+{
+    Holder(): v() {}
+
+    T v;
+
+    DEFINE_JSON_ATTRIBUTES(v)
+};
+
+/**
+ * Unpack {"v":text} into value, false if the number was rejected
+ */
+template<typename T>
+static bool decoded(const std::string &text, T &value)
+{
+    std::string json = "{\"v\":" + text + "}";
+    Holder<T> h;
+    try
+    {
+        h.json_unpack(json.data(), json.size());
+    }
+    catch(const jsonpack::type_error &)
+    {
+        return false;
+    }
+    value = h.v;
+    return true;
+}
+
+/**
+ * The decimal text one past the magnitude of text, "-128" -> "-129"
+ */
+static std::string one_past(std::string text)
+{
+    std::size_t i = text.size();
+    while(i > 0 && text[i - 1] == '9')
+        text[--i] = '0';
+
+    if(i == 0 || text[i - 1] == '-')
+        text.insert(i, "1");
+    else
+        ++text[i - 1];
+    return text;
+}
+
+template<typename T>
+static void integer_limits()
+{
+    const T min = std::numeric_limits<T>::min();
+    const T max = std::numeric_limits<T>::max();
+    const std::string min_text = std::to_string(min);
+    const std::string max_text = std::to_string(max);
+    T value = 1;
+
+    CHECK(decoded(max_text, value) && value == max);
+    CHECK(!decoded(one_past(max_text), value));
+    CHECK(decoded(min_text, value) && value == min);
+    CHECK(!decoded("1" + max_text, value));
+    CHECK(!decoded("100000000000000000000000000000", value));
+
+    if(std::numeric_limits<T>::is_signed)
+        CHECK(!decoded(one_past(min_text), value));
+    else
+        CHECK(!decoded("-1", value));
+
+    value = 1;
+    CHECK(decoded("-0", value) && value == 0);
+    CHECK(decoded("0", value) && value == 0);
+    CHECK(decoded("0000000000000000000042", value) && value == 42);
+}
+
+/**
+ * Numbers of up to 8 digits at once and longer go through different loops
+ */
+static void digit_runs()
+{
+    long long value = 0;
+    const char* runs[] = {"1", "12345678", "123456789", "1234567890123456",
+                          "12345678901234567", "999999999999999999"};
+    for(std::size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); ++i)
+        CHECK(decoded(runs[i], value) && std::to_string(value) == runs[i]);
+
+    // as strtol, an integer member takes the integral part of a real
+    int truncated = 0;
+    CHECK(decoded("-12.75e3", truncated) && truncated == -12);
+}
+
+/**
+ * The real decodes to the same bits as strtod/strtof, or is rejected where
+ * they overflow to infinity
+ */
+static bool as_strtod(const char* text, double)
+{
+    double expected = strtod(text, nullptr);
+    double value = 0;
+
+    if( std::isinf(expected) )
+        return !decoded(text, value);
+    return decoded(text, value) && memcmp(&value, &expected, sizeof(value)) == 0;
+}
+
+static bool as_strtod(const char* text, float)
+{
+    float expected = strtof(text, nullptr);
+    float value = 0;
+
+    if( std::isinf(expected) )
+        return !decoded(text, value);
+    return decoded(text, value) && memcmp(&value, &expected, sizeof(value)) == 0;
+}
+
+static void subnormals()
+{
+    CHECK(as_strtod("4.9406564584124654e-324", double()));   // smallest
+    CHECK(as_strtod("2.2250738585072009e-308", double()));   // largest
+    CHECK(as_strtod("2.2250738585072014e-308", double()));   // smallest normal
+    CHECK(as_strtod("1e-320", double()));
+    CHECK(as_strtod("-3e-324", double()));
+    CHECK(as_strtod("2e-324", double()));                    // rounds to 0
+
+    CHECK(as_strtod("1.4e-45", float()));
+    CHECK(as_strtod("1.17549421e-38", float()));
+    CHECK(as_strtod("5e-40", float()));
+}
+
+/**
+ * Exactly halfway between two doubles, and just above, with up to 19
+ * significant digits and past them
+ */
+static void halfway_rounds_to_even()
+{
+    double value = 0;
+    CHECK(decoded("9007199254740993", value) && value == 9007199254740992.0);
+    CHECK(decoded("9007199254740995", value) && value == 9007199254740996.0);
+    CHECK(as_strtod("9007199254740993.0", double()));
+    CHECK(as_strtod("1.00000000000000011102230246251565404236316680908203125", double()));
+    CHECK(as_strtod("1.00000000000000011102230246251565404236316680908203126", double()));
+    CHECK(as_strtod("2.22507385850720113605740979670913197593481954635164564e-308", double()));
+    CHECK(as_strtod("7.2057594037927933e16", double()));
+    CHECK(as_strtod("1.7976931348623157e308", double()));    // largest
+    CHECK(as_strtod("1.7976931348623158e308", double()));    // rounds down to it
+    CHECK(as_strtod("1.7976931348623159e308", double()));    // rounds to infinity
+
+    float f = 0;
+    CHECK(decoded("16777217", f) && f == 16777216.0f);
+    CHECK(decoded("16777219", f) && f == 16777220.0f);
+    CHECK(as_strtod("1.00000005960464477539062499", float()));
+    CHECK(as_strtod("3.4028235677973366e38", float()));
+}
+
+static void huge_exponents()
+{
+    CHECK(as_strtod("1e400", double()));
+    CHECK(as_strtod("-1e400", double()));
+    CHECK(as_strtod("1e99999999999999999999", double()));
+    CHECK(as_strtod("1e-400", double()));
+    CHECK(as_strtod("1e-99999999999999999999", double()));
+    CHECK(as_strtod("0e99999999999999999999", double()));
+    CHECK(as_strtod("0.0000000000000000000000000000001e330", double()));
+    CHECK(as_strtod("100000000000000000000000000000000000e-340", double()));
+    CHECK(as_strtod("1e39", float()));
+    CHECK(as_strtod("1e-50", float()));
+}
+
+static void negative_zero()
+{
+    double value = 1;
+    CHECK(decoded("-0", value) && value == 0 && std::signbit(value));
+    CHECK(decoded("-0.0e10", value) && value == 0 && std::signbit(value));
+    CHECK(decoded("-1e-400", value) && value == 0 && std::signbit(value));
+    CHECK(decoded("0", value) && value == 0 && !std::signbit(value));
+
+    float f = 1;
+    CHECK(decoded("-0", f) && f == 0 && std::signbit(f));
+}
+
+int main()
+{
+    integer_limits<int>();
+    integer_limits<unsigned int>();
+    integer_limits<long>();
+    integer_limits<unsigned long>();
+    integer_limits<long long>();
+    integer_limits<unsigned long long>();
+
+    digit_runs();
+
+    subnormals();
+    halfway_rounds_to_even();
+    huge_exponents();
+    negative_zero();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,96 @@
+/**
+ *  Jsonpack - json_append tests
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+struct Inner
+{
+    Inner(): name("in\"ner") {}
+
+    std::string name;
+
+    DEFINE_JSON_ATTRIBUTES(name)
+};
+
+struct Outer
+{
+    Outer(): id(7), inner(), tags() { tags.push_back(inner); }
+
+    int id;
+    Inner inner;
+    std::vector<Inner> tags;
+
+    DEFINE_JSON_ATTRIBUTES(id, inner, tags)
+};
+
+static const char* expected = "{\"id\":7,\"inner\":{\"name\":\"in\\\"ner\"},\"tags\":[{\"name\":\"in\\\"ner\"}]}";
+
+static void sinks()
+{
+    Outer o;
+
+    jsonpack::buffer buf;
+    o.json_append(buf);
+    CHECK(std::string(buf.data(), buf.size()) == expected);
+
+    char out[256];
+    CHECK(o.json_pack_into(out, sizeof(out)) == strlen(expected));
+    CHECK(strcmp(out, expected) == 0);
+
+    std::string written;
+    {
+        jsonpack::stream_sink stream(jsonpack::write_callback(
+            [&written](const char* data, std::size_t len) { written.append(data, len); }), 16);
+        jsonpack::json_append(o, stream);
+        stream.flush();
+    }
+    CHECK(written == expected);
+
+    jsonpack::iovec_sink iov(16, 4);
+    jsonpack::json_append(o, iov);
+    std::string gathered;
+    for(int i = 0; i < iov.iov_count(); ++i)
+        gathered.append(static_cast<const char*>(iov.iov()[i].iov_base), iov.iov()[i].iov_len);
+    CHECK(gathered == expected);
+}
+
+static void local_class()
+{
+    struct Local
+    {
+        Local(): x(1), y(2.5) {}
+
+        int x;
+        double y;
+
+        DEFINE_JSON_ATTRIBUTES(x, y)
+    };
+
+    Local l;
+    char* json = l.json_pack();
+    CHECK(strcmp(json, "{\"x\":1,\"y\":2.5}") == 0);
+
+    Local back;
+    back.x = 0;
+    back.json_unpack(json, strlen(json));
+    CHECK(back.x == 1 && back.y == 2.5);
+    free(json);
+
+    char out[8];
+    CHECK(l.json_pack_into(out, sizeof(out)) == 15 && strcmp(out, "{\"x\":1,") == 0);
+}
+
+int main()
+{
+    sinks();
+    local_class();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,40 @@
+/**
+ *  Jsonpack - json_unpack_ndjson tests
+ */
+
+#include <string>
+
+#include <jsonpack.hpp>
+#include <jsonpack/parallel.hpp>
+
+#include "test.hpp"
+
+struct Item
+{
+    Item(): id(0) {}
+
+    int id;
+
+    DEFINE_JSON_ATTRIBUTES(id)
+};
+
+int main()
+{
+    std::string json;
+    for(int i = 0; i < 5000; ++i)
+        json += "{\"id\":" + std::to_string(i) + "}\n";
+
+    std::vector<Item> items;
+    jsonpack::json_unpack_ndjson(json.data(), json.size(), items, 4);
+
+    CHECK(items.size() == 5000);
+    bool ordered = true;
+    for(std::size_t i = 0; i < items.size(); ++i)
+        ordered = ordered && items[i].id == static_cast<int>(i);
+    CHECK(ordered);
+
+    json += "{\"id\":\"bad\"}\n";
+    CHECK_THROWS(jsonpack::json_unpack_ndjson(json.data(), json.size(), items, 4), jsonpack::type_error);
+
+    return TEST_RESULT();
+}
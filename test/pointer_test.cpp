@@ -0,0 +1,130 @@
+/**
+ *  Jsonpack - json_pointer and path_set tests
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <jsonpack.hpp>
+#include <jsonpack/pointer.hpp>
+
+#include "test.hpp"
+
+struct Point
+{
+    Point(): x(0), y(0) {}
+
+    int x;
+    int y;
+
+    DEFINE_JSON_ATTRIBUTES(x, y)
+};
+
+/**
+ * Each member of an object of many keys is found through the bucket of its
+ * precomputed hash, the missing ones are not
+ */
+static void member_lookup()
+{
+    std::string json = "{";
+    for(int i = 0; i < 300; ++i)
+    {
+        char member[32];
+        sprintf(member, "%s\"k%d\":%d", i ? "," : "", i, i);
+        json += member;
+    }
+    json += ",\"a\":{\"b\":[1,{\"c\":true}]}}";
+
+    jsonpack::parser p;
+    jsonpack::object_t root;
+    CHECK(p.json_validate(json.data(), json.size(), root));
+
+    char* text = const_cast<char*>(json.data());
+    for(int i = 0; i < 300; ++i)
+    {
+        char path[16];
+        sprintf(path, "/k%d", i);
+
+        int v = -1;
+        CHECK(jsonpack::json_pointer(path).get(root, text, v) && v == i);
+    }
+
+    bool c = false;
+    CHECK(jsonpack::json_pointer("/a/b/1/c").get(root, text, c) && c);
+    CHECK(jsonpack::json_pointer("a.b[1].c").find(root) != nullptr);
+
+    CHECK(jsonpack::json_pointer("/k300").find(root) == nullptr);
+    CHECK(jsonpack::json_pointer("/k").find(root) == nullptr);
+    CHECK(jsonpack::json_pointer("/a/c").find(root) == nullptr);
+    CHECK(jsonpack::json_pointer("/a/b/2").find(root) == nullptr);
+}
+
+/**
+ * Paths sharing prefixes, a path and its own prefix, and the same path
+ * added twice are all filled from one scan
+ */
+static void overlapping_paths()
+{
+    const char* json = "{\"skip\":[{\"p\":{\"x\":0}}],"
+                       "\"p\":{\"y\":2,\"x\":1},"
+                       "\"list\":[{\"x\":5,\"y\":6},[7,8],{\"x\":9}],"
+                       "\"tail\":\"t\"}";
+
+    Point whole, in_list;
+    int x = 0, x_again = 0, x_dotted = 0, y = 0, list_x = 0, nested = 0, last_x = 0, missing = -1;
+    std::string tail;
+
+    jsonpack::path_set paths;
+    paths.add("/p", whole);
+    paths.add("/p/x", x);
+    paths.add("/p/x", x_again);
+    paths.add("p.x", x_dotted);
+    paths.add("/p/y", y);
+    paths.add("/list/0", in_list);
+    paths.add("/list/0/x", list_x);
+    paths.add("list[1][1]", nested);
+    paths.add("/list/2/x", last_x);
+    paths.add("/list/2/y", missing);
+    paths.add("/tail", tail);
+
+    CHECK(paths.extract(json, strlen(json)) == 10);
+    CHECK(whole.x == 1 && whole.y == 2);
+    CHECK(x == 1 && x_again == 1 && x_dotted == 1 && y == 2);
+    CHECK(in_list.x == 5 && in_list.y == 6 && list_x == 5);
+    CHECK(nested == 8 && last_x == 9 && tail == "t");
+    CHECK(missing == -1 && !paths.found(9) && paths.found(10));
+
+    // the same set is reused for the next document, found flags are reset
+    const char* other = "{\"p\":{\"x\":3},\"list\":[{\"x\":4,\"y\":0},[0,6]]}";
+    CHECK(paths.extract(other, strlen(other)) == 7);
+    CHECK(x == 3 && x_again == 3 && x_dotted == 3 && whole.x == 3);
+    CHECK(list_x == 4 && nested == 6 && !paths.found(4) && !paths.found(8));
+}
+
+/**
+ * Once every target is filled the rest of the text is not scanned
+ */
+static void scan_stops_when_all_found()
+{
+    const char* json = "{\"a\":{\"b\":1,\"c\":2},\"rest\": not json";
+    int b = 0, c = 0;
+
+    jsonpack::path_set paths;
+    paths.add("/a/b", b);
+    paths.add("/a/c", c);
+    CHECK(paths.extract(json, strlen(json)) == 2 && b == 1 && c == 2);
+
+    int rest = 0;
+    paths.add("/rest", rest);
+    CHECK_THROWS(paths.extract(json, strlen(json)), jsonpack::invalid_json);
+}
+
+int main()
+{
+    member_lookup();
+    overlapping_paths();
+    scan_stops_when_all_found();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,111 @@
+/**
+ *  Jsonpack - buffer_pool tests
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+struct Item
+{
+    Item(): id(0), name() {}
+
+    int id;
+    std::string name;
+
+    DEFINE_JSON_ATTRIBUTES(id, name)
+};
+
+static void same_thread_reuses_the_buffer()
+{
+    jsonpack::buffer* first = jsonpack::buffer_pool::acquire();
+    first->append(std::string(20000, 'x').c_str(), 20000);
+    std::size_t grown = first->capacity();
+    jsonpack::buffer_pool::release(first);
+
+    jsonpack::buffer* second = jsonpack::buffer_pool::acquire();
+#ifdef JSONPACK_HAS_THREAD_LOCAL
+    CHECK(second == first);
+    CHECK(second->capacity() == grown);
+#endif
+    CHECK(second->size() == 0);
+
+    // a nested acquire gets another buffer
+    jsonpack::buffer* nested = jsonpack::buffer_pool::acquire();
+    CHECK(nested != second);
+    jsonpack::buffer_pool::release(nested);
+    jsonpack::buffer_pool::release(second);
+}
+
+static void other_thread_has_its_own_pool()
+{
+    jsonpack::buffer* mine = jsonpack::buffer_pool::acquire();
+    jsonpack::buffer_pool::release(mine);
+
+    jsonpack::buffer* theirs = nullptr;
+    bool reused = false;
+    std::thread t([&]()
+    {
+        theirs = jsonpack::buffer_pool::acquire();
+        jsonpack::buffer_pool::release(theirs);
+        reused = jsonpack::buffer_pool::acquire() == theirs;
+        jsonpack::buffer_pool::release(theirs);
+    });
+    t.join();
+
+#ifdef JSONPACK_HAS_THREAD_LOCAL
+    CHECK(reused);
+#endif
+    jsonpack::buffer* again = jsonpack::buffer_pool::acquire();
+#ifdef JSONPACK_HAS_THREAD_LOCAL
+    CHECK(again == mine);
+#endif
+    jsonpack::buffer_pool::release(again);
+}
+
+static void json_pack_through_the_pool()
+{
+    Item item;
+    item.id = 7;
+    item.name = std::string(10000, 'n');
+
+    char* big = item.json_pack();
+    std::string expected = "{\"id\":7,\"name\":\"" + item.name + "\"}";
+    CHECK(strlen(big) == expected.size());
+    CHECK(expected == big);
+    free(big);
+
+    // the next call packs into the grown pool buffer, only its own content is copied
+    item.name = "a";
+    char* small = item.json_pack();
+    CHECK(std::string(small) == "{\"id\":7,\"name\":\"a\"}");
+
+    jsonpack::buffer* pooled = jsonpack::buffer_pool::acquire();
+#ifdef JSONPACK_HAS_THREAD_LOCAL
+    CHECK(pooled->capacity() >= expected.size());
+#endif
+    jsonpack::buffer_pool::release(pooled);
+    free(small);
+
+    std::vector<int> seq;
+    seq.push_back(1);
+    seq.push_back(-2);
+    char* packed = jsonpack::json_pack_sequence(seq);
+    CHECK(std::string(packed) == "[1,-2]");
+    free(packed);
+}
+
+int main()
+{
+    same_thread_reuses_the_buffer();
+    other_thread_has_its_own_pool();
+    json_pack_through_the_pool();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,175 @@
+/**
+ *  Jsonpack - json_size tests
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+struct Inner
+{
+    Inner(): s(), d(0.0) {}
+
+    std::string s;
+    double d;
+
+    DEFINE_JSON_ATTRIBUTES(s, d)
+};
+
+struct Everything
+{
+    Everything(): b(false), c('x'), i(0), u(0), l(0), ul(0), ll(0), ull(0),
+                  f(0.0f), d(0.0), s(), inner(), ints(), strings(), inners() {}
+
+    bool b;
+    char c;
+    int i;
+    unsigned int u;
+    long l;
+    unsigned long ul;
+    long long ll;
+    unsigned long long ull;
+    float f;
+    double d;
+    std::string s;
+    Inner inner;
+    std::vector<int> ints;
+    std::vector<std::string> strings;
+    std::vector<Inner> inners;
+
+    DEFINE_JSON_ATTRIBUTES(b, c, i, u, l, ul, ll, ull, f, d, s, inner, ints, strings, inners)
+};
+
+/**
+ * json_size() is the length of the json that json_pack() writes
+ */
+static bool sized(Everything &e)
+{
+    char* json = e.json_pack();
+    bool same = e.json_size() == strlen(json);
+    if(!same)
+        printf("json_size %zu for %zu bytes: %s\n", e.json_size(), strlen(json), json);
+    free(json);
+    return same;
+}
+
+static void integers()
+{
+    Everything e;
+    CHECK(sized(e));
+
+    e.i = std::numeric_limits<int>::min();
+    e.u = std::numeric_limits<unsigned int>::max();
+    e.l = std::numeric_limits<long>::min();
+    e.ul = std::numeric_limits<unsigned long>::max();
+    e.ll = std::numeric_limits<long long>::min();
+    e.ull = std::numeric_limits<unsigned long long>::max();
+    CHECK(sized(e));
+
+    e.i = std::numeric_limits<int>::max();
+    e.l = std::numeric_limits<long>::max();
+    e.ll = std::numeric_limits<long long>::max();
+    CHECK(sized(e));
+
+    // every length of negative and positive numbers
+    long long v = 1;
+    for(int digits = 1; digits <= 18; ++digits, v *= 10)
+    {
+        e.ll = -v;
+        e.i = static_cast<int>(-(v % 1000000000));
+        e.ull = static_cast<unsigned long long>(v * 9);
+        CHECK(sized(e));
+        e.ll = v - 1;
+        e.ints.push_back(static_cast<int>(-(v % 1000000000)) - 1);
+        CHECK(sized(e));
+    }
+}
+
+static void reals()
+{
+    const double doubles[] = {
+        0.0, -0.0, 0.1, -0.1, 1.0 / 3, 2.5, -1e21, 1e22, 123456789.125, 1e-7,
+        5e-324, -2.2250738585072014e-308, std::numeric_limits<double>::max(),
+        -std::numeric_limits<double>::max(), 9007199254740993.0
+    };
+    const float floats[] = {
+        0.0f, -0.5f, 1.0f / 3, 1e-45f, std::numeric_limits<float>::max(), -3.4e-38f, 16777217.0f
+    };
+
+    Everything e;
+    for(std::size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); ++i)
+    {
+        e.d = doubles[i];
+        e.inner.d = -doubles[i];
+        e.f = floats[i % (sizeof(floats) / sizeof(floats[0]))];
+        CHECK(sized(e));
+    }
+}
+
+static void strings()
+{
+    const char* texts[] = {
+        "", "plain", "\"", "\\", "q\"b\\s/", "\b\f\n\r\t", "\x01\x1f\x7f",
+        "\xc3\xa9\xe2\x82\xac", "{\"a\":[1,2]}"
+    };
+
+    Everything e;
+    for(std::size_t i = 0; i < sizeof(texts) / sizeof(texts[0]); ++i)
+    {
+        e.s = texts[i];
+        e.inner.s = std::string(40, 'x') + texts[i] + std::string(40, 'y');
+        e.strings.push_back(texts[i]);
+        CHECK(sized(e));
+    }
+
+    e.s.assign("a\0b", 3);
+    CHECK(sized(e));
+
+    const char chars[] = {'"', '\\', 'a', ' ', '\n', '\x01'};
+    for(std::size_t i = 0; i < sizeof(chars); ++i)
+    {
+        e.c = chars[i];
+        CHECK(sized(e));
+    }
+}
+
+static void sequences()
+{
+    Everything e;
+    for(int i = 0; i < 3; ++i)
+    {
+        Inner in;
+        in.s = std::string(i, '"');
+        in.d = i * -0.5;
+        e.inners.push_back(in);
+        CHECK(sized(e));
+    }
+
+    std::vector<Inner> seq;
+    CHECK(jsonpack::json_sequence_size(seq) == 2);
+    seq = e.inners;
+    char* json = jsonpack::json_pack_sequence(seq);
+    CHECK(jsonpack::json_sequence_size(seq) == strlen(json));
+    free(json);
+
+    std::vector<std::string> text(2, "t\"\\");
+    json = jsonpack::json_pack_sequence(text);
+    CHECK(jsonpack::json_sequence_size(text) == strlen(json));
+    free(json);
+}
+
+int main()
+{
+    integers();
+    reals();
+    strings();
+    sequences();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,42 @@
+/**
+ *  Jsonpack - skip_container tests
+ */
+
+#include <string>
+
+#include <jsonpack/util/skip.hpp>
+
+#include "test.hpp"
+
+/**
+ * Offset past the container opened by text[0] when skipping from the offset
+ * from inside it, or -1 if it is rejected
+ */
+static long skip(const std::string &text, std::size_t from = 1)
+{
+    const char* end = jsonpack::util::skip_container(text.c_str() + from, text.c_str() + text.size(), text[0]);
+    return end == nullptr ? -1 : static_cast<long>(end - text.c_str());
+}
+
+int main()
+{
+    CHECK(skip("[]") == 2);
+    CHECK(skip("{\"q\":[1]} ,") == 9);
+    CHECK(skip("[\"}\"]") == 5);     // brackets in strings do not count
+    CHECK(skip("{\"a\":[1],\"b\":{}}", 9) == 16);
+
+    CHECK(skip("[}") == -1);
+    CHECK(skip("{]") == -1);
+    CHECK(skip("{\"q\":[}]}") == -1);
+    CHECK(skip("{\"a\":[1],\"b\":{}]", 9) == -1);
+    CHECK(skip("[" + std::string(100, ' ') + "[{[{]]}]]") == -1);
+
+    std::string nested;
+    for(int i = 0; i < 80; ++i)
+        nested += (i % 2) ? '{' : '[';
+    for(int i = 79; i >= 0; --i)
+        nested += (i % 2) ? '}' : ']';
+    CHECK(skip(nested) == 160);
+
+    return TEST_RESULT();
+}
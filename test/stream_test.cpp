@@ -0,0 +1,144 @@
+/**
+ *  Jsonpack - stream_reader tests
+ */
+
+#include <cstring>
+#include <string>
+
+#include <jsonpack.hpp>
+#include <jsonpack/stream.hpp>
+
+#include "test.hpp"
+
+struct Item
+{
+    Item(): id(0) {}
+
+    int id;
+
+    DEFINE_JSON_ATTRIBUTES(id)
+};
+
+/**
+ * Serve text in chunks of at most chunk bytes
+ */
+struct string_source
+{
+    string_source(const std::string &text, std::size_t chunk): _text(text), _pos(0), _chunk(chunk) {}
+
+    std::size_t operator()(char* buf, std::size_t len)
+    {
+        std::size_t n = std::min(std::min(len, _chunk), _text.size() - _pos);
+        memcpy(buf, _text.data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+
+    std::string _text;
+    std::size_t _pos;
+    std::size_t _chunk;
+};
+
+static void bad_line_is_skipped(std::size_t chunk)
+{
+    jsonpack::stream_reader reader(jsonpack::read_callback(string_source(
+        "{\"id\":1}\nnot json at all\n{\"id\":2}\n\"x\" {\"id\":9}\n[1] \n{\"id\":3}\n", chunk)), chunk);
+
+    Item item;
+    CHECK(reader.next(item) && item.id == 1);
+
+    CHECK_THROWS(reader.next(item), jsonpack::invalid_json);
+    CHECK(reader.next(item) && item.id == 2);   // the reader goes on after the bad line
+
+    CHECK_THROWS(reader.next(item), jsonpack::invalid_json);
+
+    std::vector<int> seq;
+    CHECK(reader.next_sequence(seq) && seq.size() == 1 && seq[0] == 1);
+    CHECK(reader.next(item) && item.id == 3);
+    CHECK(!reader.next(item));
+}
+
+/**
+ * Documents whose strings hold brackets, quotes and backslashes across the
+ * 64 byte blocks of the scan and across the reads
+ */
+static void boundaries(std::size_t chunk)
+{
+    std::string text;
+    for(int i = 0; i < 20; ++i)
+    {
+        std::string pad(static_cast<std::size_t>(i * 7), i % 2 ? '}' : ']');
+        text += "{\"s\":\"" + pad + "\\\\\\\"{[\",\"a\":[{\"b\":[]}],\"id\":" + std::to_string(i) + "}";
+        text += (i % 3) ? "\n" : "  ";
+    }
+
+    jsonpack::stream_reader reader(jsonpack::read_callback(string_source(text, chunk)), chunk);
+
+    const char* json;
+    std::size_t len;
+    int read = 0;
+    std::size_t total = 0;
+    while( reader.next_document(json, len) )
+    {
+        CHECK(json[0] == '{' && json[len - 1] == '}');
+        total += len;
+        ++read;
+    }
+    CHECK(read == 20 && reader.count() == 20);
+    CHECK(total == text.size() - 13 - 7 * 2);   // 13 newlines and 7 double spaces between them
+}
+
+/**
+ * A document past the maximum size, or with a closing bracket of the wrong
+ * kind, is dropped up to the end of its first line
+ */
+static void bad_documents_are_dropped(std::size_t chunk)
+{
+    std::string big = "{\"id\":[" + std::string(300, '1') + "]}";
+    std::string rest;
+    for(int i = 0; i < 20; ++i)
+        rest += "{\"id\":" + std::to_string(i + 4) + "}\n";
+    jsonpack::stream_reader reader(jsonpack::read_callback(string_source(
+        "{\"id\":1}\n" + big + "\n{\"id\":2}\n{\"id\":[1}\n{\"id\":3}\n{\"id\":[\"never closed\"\n" + rest, chunk)),
+        chunk, 100);
+
+    Item item;
+    CHECK(reader.next(item) && item.id == 1);
+    CHECK_THROWS(reader.next(item), jsonpack::invalid_json);
+    CHECK(reader.next(item) && item.id == 2);
+    CHECK_THROWS(reader.next(item), jsonpack::invalid_json);
+    CHECK(reader.next(item) && item.id == 3);
+
+    // an unterminated document takes the next lines up to the maximum size
+    CHECK_THROWS(reader.next(item), jsonpack::invalid_json);
+    for(int i = 0; i < 20; ++i)
+        CHECK(reader.next(item) && item.id == i + 4);
+    CHECK(!reader.next(item));
+}
+
+static void truncated_at_the_end()
+{
+    jsonpack::stream_reader reader(jsonpack::read_callback(string_source("{\"id\":1} {\"id\":", 3)), 3);
+
+    Item item;
+    CHECK(reader.next(item) && item.id == 1);
+    CHECK_THROWS(reader.next(item), jsonpack::invalid_json);
+    CHECK(!reader.next(item));
+}
+
+int main()
+{
+    bad_line_is_skipped(65536);
+    bad_line_is_skipped(4);     // the bad line spans several reads
+    bad_line_is_skipped(1);
+
+    std::size_t chunks[] = {1, 7, 64, 65536};
+    for(std::size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); ++i)
+    {
+        boundaries(chunks[i]);
+        bad_documents_are_dropped(chunks[i]);
+    }
+    truncated_at_the_end();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,195 @@
+/**
+ *  Jsonpack - string literal tests
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <jsonpack.hpp>
+
+#include "test.hpp"
+
+struct Text
+{
+    Text(): s() {}
+
+    std::string s;
+
+    DEFINE_JSON_ATTRIBUTES(s)
+};
+
+struct Ref
+{
+    Ref(): r() {}
+
+    jsonpack::str_ref r;
+
+    DEFINE_JSON_ATTRIBUTES(r)
+};
+
+/**
+ * Decode {"s":"literal"} into a std::string with a copying or an in-situ parse
+ */
+static std::string decoded(const std::string &literal, bool insitu)
+{
+    std::string json = "{\"s\":\"" + literal + "\"}";
+    std::vector<char> text(json.begin(), json.end());
+    Text t;
+
+    if(insitu)
+        t.json_unpack_insitu(text.data(), text.size());
+    else
+        t.json_unpack(text.data(), text.size());
+    return t.s;
+}
+
+static bool rejected(const std::string &literal, bool insitu)
+{
+    try
+    {
+        decoded(literal, insitu);
+    }
+    catch(const jsonpack::invalid_json &)
+    {
+        return true;
+    }
+    return false;
+}
+
+static void escapes(bool insitu)
+{
+    CHECK(decoded("plain", insitu) == "plain");
+    CHECK(decoded("a\\\"b\\\\c\\/d", insitu) == "a\"b\\c/d");
+    CHECK(decoded("\\b\\f\\n\\r\\t", insitu) == "\b\f\n\r\t");
+    CHECK(decoded("\\\"", insitu) == "\"");
+    CHECK(decoded("end\\\\", insitu) == "end\\");
+
+    // the clean runs between escapes are longer than a SIMD block
+    std::string run(40, 'x');
+    CHECK(decoded(run + "\\n" + run + "\\\"" + run, insitu) == run + "\n" + run + "\"" + run);
+
+    CHECK(decoded("\\u0041\\u00e9\\u20AC", insitu) == "A\xc3\xa9\xe2\x82\xac");
+    CHECK(decoded("\\u0000", insitu) == std::string(1, '\0'));
+    CHECK(decoded("\\ud83d\\ude00!", insitu) == "\xf0\x9f\x98\x80!");
+    CHECK(decoded("\\uDBFF\\uDFFF", insitu) == "\xf4\x8f\xbf\xbf");
+
+    CHECK(rejected("\\x", insitu));
+    CHECK(rejected("\\u12", insitu));
+    CHECK(rejected("\\u12g4", insitu));
+    CHECK(rejected("\\ud83d", insitu));          // high surrogate alone
+    CHECK(rejected("\\ud83d\\u0041", insitu));   // followed by no low one
+    CHECK(rejected("\\ude00", insitu));          // low surrogate alone
+}
+
+/**
+ * In-situ parsing decodes in the text itself, the references point into it
+ */
+static void insitu_references()
+{
+    char json[] = "{\"r\":\"a\\tb\\u00e9c\"}";
+    Ref ref;
+    ref.json_unpack_insitu(json, strlen(json));
+
+    CHECK(!ref.r.owns());
+    CHECK(ref.r.data() >= json && ref.r.data() < json + sizeof(json));
+    CHECK(ref.r.str() == "a\tb\xc3\xa9" "c");
+
+    // without in-situ parsing an escaped string is decoded into its own copy
+    const char* copied = "{\"r\":\"a\\tb\"}";
+    ref.json_unpack(copied, strlen(copied));
+    CHECK(ref.r.owns() && ref.r.str() == "a\tb");
+
+    // escaped keys are matched once decoded
+    char key[] = "{\"\\u0073\":\"k\"}";
+    Text t;
+    t.json_unpack_insitu(key, strlen(key));
+    CHECK(t.s == "k");
+
+#ifdef JSONPACK_HAS_STRING_VIEW
+    struct View
+    {
+        View(): v() {}
+
+        std::string_view v;
+
+        DEFINE_JSON_ATTRIBUTES(v)
+    };
+
+    char view_json[] = "{\"v\":\"x\\\"y\\u00e9\"}";
+    View view;
+    view.json_unpack_insitu(view_json, strlen(view_json));
+    CHECK(view.v == "x\"y\xc3\xa9");
+    CHECK(view.v.data() > view_json && view.v.data() < view_json + sizeof(view_json));
+
+    View copy;
+    CHECK_THROWS(copy.json_unpack("{\"v\":\"x\\n\"}", 11), jsonpack::type_error);
+#endif
+}
+
+/**
+ * Offset of the invalid UTF-8 reported by json_validate, npos if accepted
+ */
+static std::size_t bad_utf8(const std::string &json)
+{
+    jsonpack::parser p(jsonpack::PARSE_VALIDATE_UTF8);
+    jsonpack::object_t members;
+
+    if( p.json_validate(json.data(), json.size(), members) )
+        return std::string::npos;
+
+    CHECK(p.error_.find(std::to_string(p.utf8_error_offset())) != std::string::npos);
+    return p.utf8_error_offset();
+}
+
+/**
+ * The first invalid byte is found at short and long offsets into a string,
+ * on both sides of the SIMD block boundaries
+ */
+static void utf8_validation()
+{
+    const char* valid[] = {"\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf", "\xef\xbb\xbf"};
+    const char* invalid[] = {
+        "\x80",                     // continuation without a lead
+        "\xc0\x80",                 // overlong
+        "\xe0\x80\xaf",             // overlong
+        "\xed\xa0\x80",             // surrogate
+        "\xf4\x90\x80\x80",         // above U+10FFFF
+        "\xf8\x88\x80\x80\x80",     // 5 byte form
+        "\xff",
+        "\xe2\x82",                 // truncated 3 byte form
+        "\xc3" "A"                  // truncated 2 byte form
+    };
+
+    std::size_t prefixes[] = {0, 1, 15, 16, 31, 32, 33, 70};
+    for(std::size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); ++i)
+    {
+        std::string head = "{\"a\":\"" + std::string(prefixes[i], 'x');
+
+        for(std::size_t v = 0; v < sizeof(valid) / sizeof(valid[0]); ++v)
+            CHECK(bad_utf8(head + valid[v] + "yy\"}") == std::string::npos);
+
+        for(std::size_t b = 0; b < sizeof(invalid) / sizeof(invalid[0]); ++b)
+            CHECK(bad_utf8(head + invalid[b] + "yy\"}") == head.size());
+    }
+
+    // keys are checked too, after an escape the offset still refers to the text
+    CHECK(bad_utf8("{\"k\\n\xc3\x28\":1}") == 5);
+    CHECK(bad_utf8("{\"a\":\"\\u00e9\xe9\"}") == 12);
+
+    // without the flag the bytes are taken as they are
+    std::string raw = "{\"s\":\"\xff\xfe\"}";
+    Text t;
+    t.json_unpack(raw.data(), raw.size());
+    CHECK(t.s == "\xff\xfe");
+}
+
+int main()
+{
+    escapes(false);
+    escapes(true);
+    insitu_references();
+    utf8_validation();
+
+    return TEST_RESULT();
+}
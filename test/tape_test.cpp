@@ -0,0 +1,159 @@
+/**
+ *  Jsonpack - tape tests
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <jsonpack.hpp>
+#include <jsonpack/tape.hpp>
+
+#include "test.hpp"
+
+struct Point
+{
+    Point(): x(0), y(0.0), tags() {}
+
+    int x;
+    double y;
+    std::vector<std::string> tags;
+
+    DEFINE_JSON_ATTRIBUTES(x, y, tags)
+};
+
+static const char* document =
+    "{\"id\":-12,\"pi\":3.25e-2,\"ok\":true,\"no\":false,\"none\":null,"
+    "\"text\":\"q\\\"b\\\\n\\u00e9\",\"empty\":{},\"list\":[],"
+    "\"points\":[{\"x\":1,\"y\":2.5,\"tags\":[\"a\",\"b\"]},{\"x\":3,\"y\":-1,\"tags\":[]}],"
+    "\"deep\":[[[[1]]],{\"k\":{\"k\":[0]}}]}";
+
+static std::string appended(const jsonpack::tape_ref &r)
+{
+    jsonpack::buffer json;
+    r.append(json);
+    return std::string(json.data(), json.size());
+}
+
+/**
+ * The compact text written from the tape is the text parsed, and parses
+ * to the same tape again
+ */
+static void round_trip()
+{
+    jsonpack::parser p;
+    jsonpack::tape t;
+    CHECK(p.json_validate(document, strlen(document), t));
+
+    std::string out = appended(t.root());
+    CHECK(out == document);
+
+    jsonpack::tape again;
+    CHECK(p.json_validate(out.data(), out.size(), again));
+    CHECK(again.size() == t.size());
+    CHECK(appended(again.root()) == out);
+
+    // subtrees are written alone
+    CHECK(appended(t.root()["points"][1]) == "{\"x\":3,\"y\":-1,\"tags\":[]}");
+    CHECK(appended(t.root()["deep"][0]) == "[[[1]]]");
+    CHECK(appended(t.root()["text"]) == "\"q\\\"b\\\\n\\u00e9\"");
+    CHECK(appended(t.root()["missing"]).empty());
+
+    // whitespace is dropped
+    const char* spaced = " { \"a\" : [ 1 , { } , \"s\" ] , \"b\" : null } ";
+    jsonpack::tape s;
+    CHECK(p.json_validate(spaced, strlen(spaced), s));
+    CHECK(appended(s.root()) == "{\"a\":[1,{},\"s\"],\"b\":null}");
+}
+
+/**
+ * Values rebuilt by to_value decode as the parsed map would
+ */
+static void to_value()
+{
+    jsonpack::parser p;
+    jsonpack::tape t;
+    CHECK(p.json_validate(document, strlen(document), t));
+    jsonpack::tape_ref root = t.root();
+
+    CHECK(root["id"].get<int>() == -12);
+    CHECK(root["pi"].get<double>() == 3.25e-2);
+    CHECK(root["ok"].get<bool>() && !root["no"].get<bool>());
+    CHECK(root["text"].get<std::string>() == "q\"b\\n\xc3\xa9");
+
+    std::vector<Point> points = root["points"].get< std::vector<Point> >();
+    CHECK(points.size() == 2);
+    CHECK(points[0].x == 1 && points[0].y == 2.5 && points[0].tags.size() == 2 && points[0].tags[1] == "b");
+    CHECK(points[1].x == 3 && points[1].y == -1 && points[1].tags.empty());
+
+    Point first = root["points"][0].get<Point>();
+    char* packed = first.json_pack();
+    CHECK(std::string(packed) == appended(root["points"][0]));
+    free(packed);
+
+    CHECK(root["deep"][1]["k"]["k"][0].get<int>() == 0);
+    CHECK(root["deep"][0][0][0][0].get<int>() == 1);
+    CHECK(root["empty"].size() == 0 && root["list"].size() == 0 && root["points"].size() == 2);
+    CHECK_THROWS(root["text"].get<int>(), jsonpack::type_error);
+
+    // the tape is reused for the next document
+    const char* next = "[7]";
+    CHECK(p.json_validate(next, strlen(next), t));
+    CHECK(t.root()[0].get<int>() == 7 && appended(t.root()) == next);
+}
+
+/**
+ * With in-situ parsing the strings are decoded in the text and escaped
+ * again on the way out
+ */
+static void insitu_round_trip()
+{
+    std::vector<char> text(document, document + strlen(document));
+    jsonpack::parser p(jsonpack::PARSE_INSITU);
+    jsonpack::tape t;
+    CHECK(p.json_validate(text.data(), text.size(), t));
+
+    CHECK(t.root()["text"].get<std::string>() == "q\"b\\n\xc3\xa9");
+    CHECK(appended(t.root()["text"]) == "\"q\\\"b\\\\n\xc3\xa9\"");
+    CHECK(appended(t.root()["points"]) ==
+          "[{\"x\":1,\"y\":2.5,\"tags\":[\"a\",\"b\"]},{\"x\":3,\"y\":-1,\"tags\":[]}]");
+}
+
+static void sinks()
+{
+    jsonpack::parser p;
+    jsonpack::tape t;
+    CHECK(p.json_validate(document, strlen(document), t));
+
+    std::vector<char> out(strlen(document) + 1);
+    jsonpack::span_sink span(out.data(), out.size());
+    t.root().append(span);
+    CHECK(span.terminate() == strlen(document) && strcmp(out.data(), document) == 0);
+
+    std::string written;
+    {
+        jsonpack::stream_sink stream(jsonpack::write_callback(
+            [&written](const char* data, std::size_t len) { written.append(data, len); }), 16);
+        t.root().append(stream);
+        stream.flush();
+    }
+    CHECK(written == document);
+
+    jsonpack::iovec_sink iov(16, 4);
+    t.root().append(iov);
+    std::string gathered;
+    for(int i = 0; i < iov.iov_count(); ++i)
+        gathered.append(static_cast<const char*>(iov.iov()[i].iov_base), iov.iov()[i].iov_len);
+    CHECK(gathered == document);
+}
+
+int main()
+{
+    round_trip();
+    to_value();
+    insitu_round_trip();
+    sinks();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,34 @@
+/**
+ *  Jsonpack - Minimal checks for the test programs
+ */
+
+#ifndef JSONPACK_TEST_HPP
+#define JSONPACK_TEST_HPP
+
+#include <cstdio>
+
+static int test_failures = 0;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if( !(cond) )                                                   \
+        {                                                               \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);\
+            ++test_failures;                                            \
+        }                                                               \
+    } while(0)
+
+#define CHECK_THROWS(expr, error)                                       \
+    do {                                                                \
+        bool _thrown = false;                                           \
+        try { expr; } catch(const error &) { _thrown = true; }          \
+        if( !_thrown )                                                  \
+        {                                                               \
+            printf("%s:%d: expected %s from: %s\n", __FILE__, __LINE__, #error, #expr);\
+            ++test_failures;                                            \
+        }                                                               \
+    } while(0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
+
+#endif // JSONPACK_TEST_HPP